@@ -0,0 +1,425 @@
+/*
+ * kd_grid/bool_kd_grid.h
+ *
+ * The KDGrid<bool, K> specialization, which packs 64 cells into each word. This
+ * is included by kd_grid/kd_grid.h, so that the specialization is always visible.
+ * It only covers the default (row major) layout.
+ *
+ * Cells are bits, so operator[] returns a proxy (like std::vector<bool>) rather
+ * than a bool&. The point of packing is the whole grid operations, which work on
+ * a word (64 cells) at a time.
+ */
+#ifndef jackcasey067_KD_GRID_BOOL_KD_GRID_H
+#define jackcasey067_KD_GRID_BOOL_KD_GRID_H
+
+#include "kd_grid.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Util {
+    /* Each row along the last dimension starts on a fresh word, and bit b of word w
+     * in a row is the cell at (min of last dimension) + 64 * w + b. Bits past the
+     * end of a row are always zero. */
+    template<int K>
+    class KDGrid<bool, K, RowMajorLayout> {
+        static_assert(K >= 1, "KDGrid needs at least one dimension.");
+
+    public:
+        using Word = std::uint64_t;
+        static constexpr int word_bits {64};
+
+        class reference {
+        private:
+            Word* word;
+            Word mask;
+
+            reference(Word* word, Word mask) : word {word}, mask {mask} {}
+
+            friend class KDGrid;
+
+        public:
+            operator bool() const {
+                return (*word & mask) != 0;
+            }
+
+            reference& operator=(bool value) {
+                *word = value ? (*word | mask) : (*word & ~mask);
+                return *this;
+            }
+
+            reference& operator=(const reference& other) {
+                return *this = static_cast<bool>(other);
+            }
+
+            void flip() {
+                *word ^= mask;
+            }
+        };
+
+    private:
+        std::array<int, K*2> bounds; // min1, max1, min2, max2, ...
+
+        int row_length;
+        std::size_t words_per_row;
+        Word tail_mask; // The valid bits of the last word in a row.
+
+        /* row_strides[k] is the number of rows between neighbours in dimension k.
+         * The last dimension runs along a row, so its entry is unused. */
+        std::array<std::size_t, K> row_strides;
+        std::size_t row_count;
+
+        std::vector<Word> words;
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* Takes an array of the inclusive bounds in order. Eg {{-10, 10, -10, 10}}*/
+        KDGrid(std::array<int, K*2> bounds, bool default_value) : bounds {bounds} {
+            std::size_t rows {1};
+            for (int k {K - 1}; k >= 0; k--) {
+                if (bounds[2 * k+1] < bounds[2 * k]) {
+                    throw std::invalid_argument("KDGrid: In the " + std::to_string(k + 1) + "'th dimension, max "
+                        + std::to_string(bounds[2 * k+1]) + " is less than min " + std::to_string(bounds[2 * k]));
+                }
+                row_strides[k] = rows;
+                if (k != K - 1) {
+                    rows *= static_cast<std::size_t>(bounds[2 * k+1] - bounds[2 * k] + 1);
+                }
+            }
+            row_count = rows;
+
+            row_length = bounds[2 * K - 1] - bounds[2 * K - 2] + 1;
+            words_per_row = (static_cast<std::size_t>(row_length) + word_bits - 1) / word_bits;
+            tail_mask = row_length % word_bits == 0 ? ~Word {0} : (Word {1} << (row_length % word_bits)) - 1;
+
+            words.assign(row_count * words_per_row, 0);
+            fill(default_value);
+        }
+
+        KDGrid(std::array<int, K*2> bounds) : KDGrid(bounds, false) {}
+
+        reference operator[](const std::array<int, K>& indices) {
+            check(indices);
+            return get_unchecked(indices);
+        }
+
+        bool operator[](const std::array<int, K>& indices) const {
+            check(indices);
+            return get_unchecked(indices);
+        }
+
+        /* Skips the bounds check. Out of bounds indices are undefined behavior. */
+        reference get_unchecked(const std::array<int, K>& indices) {
+            auto [word, bit] {locate(indices)};
+            return reference(&words[word], Word {1} << bit);
+        }
+
+        bool get_unchecked(const std::array<int, K>& indices) const {
+            auto [word, bit] {locate(indices)};
+            return (words[word] >> bit) & 1;
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /* The inclusive bounds, in the order given to the constructor. */
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        std::size_t size() const {
+            return row_count * row_length;
+        }
+
+        /* The words of the row through indices (whose last index is ignored). See the
+         * class comment for the bit layout. */
+        std::span<Word> row_words(const std::array<int, K>& indices) {
+            check(indices);
+            return std::span<Word>(&words[row_of(indices) * words_per_row], words_per_row);
+        }
+
+        std::span<const Word> row_words(const std::array<int, K>& indices) const {
+            check(indices);
+            return std::span<const Word>(&words[row_of(indices) * words_per_row], words_per_row);
+        }
+
+        /* Sets the cell and returns its old value, as one atomic operation, so that
+         * threads racing to claim a cell agree on who got there first. Safe to call
+         * concurrently with itself (on any cells), but not with anything that
+         * writes. No bounds check. */
+        bool atomic_test_and_set(const std::array<int, K>& indices) {
+            auto [word, bit] {locate(indices)};
+            const Word mask {Word {1} << bit};
+            return (std::atomic_ref<Word>(words[word]).fetch_or(mask, std::memory_order_relaxed) & mask) != 0;
+        }
+
+        /* Bulk operations. */
+
+        void fill(bool value) {
+            for (std::size_t row {0}; row < row_count; row++) {
+                Word* first {&words[row * words_per_row]};
+                std::fill_n(first, words_per_row, value ? ~Word {0} : Word {0});
+                first[words_per_row - 1] &= tail_mask;
+            }
+        }
+
+        /* Sets every cell in the inclusive box from min to max. */
+        void fill(const std::array<int, K>& min, const std::array<int, K>& max, bool value) {
+            for_each_row_span(*this, min, max, [value](Word* word, Word mask) {
+                *word = value ? (*word | mask) : (*word & ~mask);
+            });
+        }
+
+        /* The number of set cells. */
+        std::size_t count() const {
+            std::size_t total {0};
+            for (Word word : words) {
+                total += std::popcount(word);
+            }
+            return total;
+        }
+
+        /* The number of set cells in the inclusive box from min to max. */
+        std::size_t count(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            std::size_t total {0};
+            for_each_row_span(*this, min, max, [&total](const Word* word, Word mask) {
+                total += std::popcount(*word & mask);
+            });
+            return total;
+        }
+
+        KDGrid& operator&=(const KDGrid& other) {
+            check_same_bounds(other);
+            for (std::size_t i {0}; i < words.size(); i++) {
+                words[i] &= other.words[i];
+            }
+            return *this;
+        }
+
+        KDGrid& operator|=(const KDGrid& other) {
+            check_same_bounds(other);
+            for (std::size_t i {0}; i < words.size(); i++) {
+                words[i] |= other.words[i];
+            }
+            return *this;
+        }
+
+        KDGrid& operator^=(const KDGrid& other) {
+            check_same_bounds(other);
+            for (std::size_t i {0}; i < words.size(); i++) {
+                words[i] ^= other.words[i];
+            }
+            return *this;
+        }
+
+        friend KDGrid operator&(KDGrid left, const KDGrid& right) {
+            return left &= right;
+        }
+
+        friend KDGrid operator|(KDGrid left, const KDGrid& right) {
+            return left |= right;
+        }
+
+        friend KDGrid operator^(KDGrid left, const KDGrid& right) {
+            return left ^= right;
+        }
+
+        /* Inverts every cell. */
+        void flip() {
+            for (std::size_t row {0}; row < row_count; row++) {
+                Word* first {&words[row * words_per_row]};
+                for (std::size_t w {0}; w < words_per_row; w++) {
+                    first[w] = ~first[w];
+                }
+                first[words_per_row - 1] &= tail_mask;
+            }
+        }
+
+        /* Moves every cell amount steps along the given dimension (0 indexed), so
+         * the cell at i ends up at i + amount. Cells shifted past the bounds are
+         * lost, and vacated cells become false. */
+        void shift(int dimension, int amount) {
+            if (dimension < 0 || dimension >= K) {
+                throw std::invalid_argument("KDGrid: Cannot shift along dimension " + std::to_string(dimension));
+            }
+            if (dimension == K - 1) {
+                for (std::size_t row {0}; row < row_count; row++) {
+                    shift_row(&words[row * words_per_row], amount);
+                }
+            }
+            else {
+                shift_rows(dimension, amount);
+            }
+        }
+
+        bool operator==(const KDGrid& other) const {
+            return bounds == other.bounds && words == other.words;
+        }
+
+    private:
+        std::size_t row_of(const std::array<int, K>& indices) const {
+            std::size_t row {0};
+            for (int k {0}; k < K - 1; k++) {
+                row += static_cast<std::size_t>(indices[k] - bounds[2 * k]) * row_strides[k];
+            }
+            return row;
+        }
+
+        /* The word index, and the bit within it. */
+        std::pair<std::size_t, int> locate(const std::array<int, K>& indices) const {
+            std::size_t column {static_cast<std::size_t>(indices[K - 1] - bounds[2 * K - 2])};
+            return {row_of(indices) * words_per_row + column / word_bits, static_cast<int>(column % word_bits)};
+        }
+
+        /* Calls func(word, mask) for each word overlapping the inclusive box, where
+         * mask selects the bits of the word inside the box. */
+        template<typename Self, typename Func>
+        static void for_each_row_span(Self& self, const std::array<int, K>& min, const std::array<int, K>& max, Func func) {
+            for (int k {0}; k < K; k++) {
+                if (min[k] > max[k]) {
+                    throw std::invalid_argument("KDGrid: Region is empty in the " + std::to_string(k + 1) + "'th dimension.");
+                }
+            }
+            self.check(min);
+            self.check(max);
+
+            const std::size_t first_column {static_cast<std::size_t>(min[K - 1] - self.bounds[2 * K - 2])};
+            const std::size_t last_column {static_cast<std::size_t>(max[K - 1] - self.bounds[2 * K - 2])};
+            const std::size_t first_word {first_column / word_bits};
+            const std::size_t last_word {last_column / word_bits};
+            const Word first_mask {~Word {0} << (first_column % word_bits)};
+            const Word last_mask {~Word {0} >> (word_bits - 1 - last_column % word_bits)};
+
+            std::array<int, K> indices {min};
+            while (true) {
+                auto* row {&self.words[self.row_of(indices) * self.words_per_row]};
+                if (first_word == last_word) {
+                    func(&row[first_word], first_mask & last_mask);
+                }
+                else {
+                    func(&row[first_word], first_mask);
+                    for (std::size_t w {first_word + 1}; w < last_word; w++) {
+                        func(&row[w], ~Word {0});
+                    }
+                    func(&row[last_word], last_mask);
+                }
+
+                int k {K - 2};
+                while (k >= 0 && indices[k] == max[k]) {
+                    indices[k] = min[k];
+                    k--;
+                }
+                if (k < 0) {
+                    return;
+                }
+                indices[k]++;
+            }
+        }
+
+        /* Shifts the bits of one row towards higher indices (or lower, if amount is
+         * negative). */
+        void shift_row(Word* row, int amount) {
+            const std::size_t n {words_per_row};
+            const std::size_t distance {static_cast<std::size_t>(amount < 0 ? -static_cast<long long>(amount) : amount)};
+            const std::size_t word_shift {distance / word_bits};
+            const int bit_shift {static_cast<int>(distance % word_bits)};
+
+            if (distance >= static_cast<std::size_t>(row_length)) {
+                std::fill_n(row, n, Word {0});
+                return;
+            }
+
+            if (amount > 0) {
+                for (std::size_t w {n}; w-- > 0;) {
+                    Word shifted {0};
+                    if (w >= word_shift) {
+                        shifted = row[w - word_shift] << bit_shift;
+                        if (bit_shift != 0 && w >= word_shift + 1) {
+                            shifted |= row[w - word_shift - 1] >> (word_bits - bit_shift);
+                        }
+                    }
+                    row[w] = shifted;
+                }
+                row[n - 1] &= tail_mask;
+            }
+            else if (amount < 0) {
+                for (std::size_t w {0}; w < n; w++) {
+                    Word shifted {0};
+                    if (w + word_shift < n) {
+                        shifted = row[w + word_shift] >> bit_shift;
+                        if (bit_shift != 0 && w + word_shift + 1 < n) {
+                            shifted |= row[w + word_shift + 1] << (word_bits - bit_shift);
+                        }
+                    }
+                    row[w] = shifted;
+                }
+            }
+        }
+
+        /* Shifting along any dimension but the last moves whole rows. */
+        void shift_rows(int dimension, int amount) {
+            const long long extent {bounds[2 * dimension+1] - bounds[2 * dimension] + 1LL};
+            const std::size_t stride {row_strides[dimension]};
+
+            auto move_row = [&](std::size_t row) {
+                long long coordinate {static_cast<long long>((row / stride) % extent)};
+                Word* target {&words[row * words_per_row]};
+                if (coordinate - amount < 0 || coordinate - amount >= extent) {
+                    std::fill_n(target, words_per_row, Word {0});
+                }
+                else {
+                    std::size_t source {static_cast<std::size_t>(static_cast<long long>(row) - amount * static_cast<long long>(stride))};
+                    std::copy_n(&words[source * words_per_row], words_per_row, target);
+                }
+            };
+
+            // Go against the direction of movement so that sources are read before they are overwritten.
+            if (amount > 0) {
+                for (std::size_t row {row_count}; row-- > 0;) {
+                    move_row(row);
+                }
+            }
+            else if (amount < 0) {
+                for (std::size_t row {0}; row < row_count; row++) {
+                    move_row(row);
+                }
+            }
+        }
+
+        void check(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+        }
+
+        void check_same_bounds(const KDGrid& other) const {
+            if (bounds != other.bounds) {
+                throw std::invalid_argument("KDGrid: Bitwise operations need grids with the same bounds.");
+            }
+        }
+
+        [[noreturn, gnu::cold, gnu::noinline]] void throw_out_of_range(int k, int index) const {
+            throw std::out_of_range("KDGrid: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_BOOL_KD_GRID_H */
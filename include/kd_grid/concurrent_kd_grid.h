@@ -0,0 +1,208 @@
+/*
+ * kd_grid/concurrent_kd_grid.h
+ *
+ * A KDGrid that many threads can update at once. Cells of atomic friendly types
+ * are updated lock free in place (through std::atomic_ref, so the cells are plain
+ * T and cost nothing extra). Anything else goes through region locks: the grid is
+ * cut into stripes along the first dimension, each with its own mutex, so threads
+ * working on different parts of the grid never wait on each other.
+ */
+#ifndef jackcasey067_KD_GRID_CONCURRENT_KD_GRID_H
+#define jackcasey067_KD_GRID_CONCURRENT_KD_GRID_H
+
+#include "kd_grid.h"
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        template<typename T>
+        concept AtomicCell = std::is_trivially_copyable_v<T> && std::atomic_ref<T>::required_alignment <= alignof(T);
+
+        template<typename T>
+        concept ArithmeticCell = AtomicCell<T> && (std::integral<T> || std::floating_point<T>) && !std::same_as<T, bool>;
+    }
+
+    /* The atomic operations and the region locks do not know about each other, so
+     * any one cell should be updated only one way or the other. */
+    template<typename T, int K>
+        requires (!std::is_same_v<T, bool>)
+    class ConcurrentKDGrid {
+    private:
+        KDGrid<T, K> grid;
+
+        /* Slices (along the first dimension) per stripe. */
+        int stripe_width;
+        mutable std::vector<std::mutex> stripes;
+
+        /* Holds a run of stripes, and releases them in reverse order. */
+        class StripeLock {
+        private:
+            std::vector<std::mutex>& stripes;
+            int first;
+            int last;
+
+        public:
+            StripeLock(std::vector<std::mutex>& stripes, int first, int last) : stripes {stripes}, first {first}, last {last} {
+                // Always in ascending order, so two threads can never each hold a
+                // stripe the other is waiting for.
+                for (int s {first}; s <= last; s++) {
+                    stripes[s].lock();
+                }
+            }
+
+            ~StripeLock() {
+                for (int s {last}; s >= first; s--) {
+                    stripes[s].unlock();
+                }
+            }
+
+            StripeLock(const StripeLock&) = delete;
+            StripeLock& operator=(const StripeLock&) = delete;
+        };
+
+    public:
+        static constexpr int dimensions {K};
+
+        ConcurrentKDGrid(std::array<int, K*2> bounds, T default_value, int stripe_width = 8)
+            : grid {bounds, default_value}, stripe_width {check_stripe_width(stripe_width)},
+              stripes (static_cast<std::size_t>((static_cast<long long>(bounds[1]) - bounds[0]) / stripe_width + 1))
+        {}
+
+        ConcurrentKDGrid(std::array<int, K*2> bounds) requires std::default_initializable<T>
+            : ConcurrentKDGrid(bounds, {}) {}
+
+        /* Lock free access. Each is one atomic operation on one cell, with bounds
+         * checked first, and takes a memory order as std::atomic does. */
+
+        T load(const std::array<int, K>& indices, std::memory_order order = std::memory_order_seq_cst) const
+                requires __Util__Impl::AtomicCell<T> {
+            return std::atomic_ref<T>(cell(indices)).load(order);
+        }
+
+        void store(const std::array<int, K>& indices, T value, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::AtomicCell<T> {
+            std::atomic_ref<T>(cell(indices)).store(value, order);
+        }
+
+        T exchange(const std::array<int, K>& indices, T value, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::AtomicCell<T> {
+            return std::atomic_ref<T>(cell(indices)).exchange(value, order);
+        }
+
+        /* Like std::atomic::compare_exchange_strong: on failure, expected is set to
+         * the cell's value. */
+        bool compare_exchange(const std::array<int, K>& indices, T& expected, T desired,
+                std::memory_order order = std::memory_order_seq_cst) requires __Util__Impl::AtomicCell<T> {
+            return std::atomic_ref<T>(cell(indices)).compare_exchange_strong(expected, desired, order);
+        }
+
+        /* The fetch_ operations return the value from before the update. */
+
+        T fetch_add(const std::array<int, K>& indices, T delta, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::ArithmeticCell<T> {
+            return std::atomic_ref<T>(cell(indices)).fetch_add(delta, order);
+        }
+
+        T fetch_sub(const std::array<int, K>& indices, T delta, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::ArithmeticCell<T> {
+            return std::atomic_ref<T>(cell(indices)).fetch_sub(delta, order);
+        }
+
+        /* Lowers the cell to value if value is smaller. */
+        T fetch_min(const std::array<int, K>& indices, T value, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::AtomicCell<T> && std::totally_ordered<T> {
+            std::atomic_ref<T> target {cell(indices)};
+            T current {target.load(std::memory_order_relaxed)};
+            while (value < current && !target.compare_exchange_weak(current, value, order, std::memory_order_relaxed)) {}
+            return current;
+        }
+
+        /* Raises the cell to value if value is larger. */
+        T fetch_max(const std::array<int, K>& indices, T value, std::memory_order order = std::memory_order_seq_cst)
+                requires __Util__Impl::AtomicCell<T> && std::totally_ordered<T> {
+            std::atomic_ref<T> target {cell(indices)};
+            T current {target.load(std::memory_order_relaxed)};
+            while (current < value && !target.compare_exchange_weak(current, value, order, std::memory_order_relaxed)) {}
+            return current;
+        }
+
+        /* Locked access. */
+
+        /* Locks the stripes covering the inclusive box from min to max, and returns
+         * func(region) for that box. The region must not escape func. */
+        template<typename Func>
+        decltype(auto) with_region(const std::array<int, K>& min, const std::array<int, K>& max, Func func) {
+            auto region {grid.region(min, max)}; // Checks bounds.
+            StripeLock lock {stripes, stripe_of(min[0]), stripe_of(max[0])};
+            return func(region);
+        }
+
+        template<typename Func>
+        decltype(auto) with_region(const std::array<int, K>& min, const std::array<int, K>& max, Func func) const {
+            auto region {grid.region(min, max)};
+            StripeLock lock {stripes, stripe_of(min[0]), stripe_of(max[0])};
+            return func(region);
+        }
+
+        /* Locks the stripe holding the cell, and returns func(cell). */
+        template<typename Func>
+        decltype(auto) with_cell(const std::array<int, K>& indices, Func func) {
+            T& target {cell(indices)};
+            StripeLock lock {stripes, stripe_of(indices[0]), stripe_of(indices[0])};
+            return func(target);
+        }
+
+        /* The grid itself, without any synchronization, for phases where only one
+         * thread touches it (or everyone only reads). */
+        KDGrid<T, K>& unsynchronized() {
+            return grid;
+        }
+
+        const KDGrid<T, K>& unsynchronized() const {
+            return grid;
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            return grid.in_bounds(indices);
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return grid.get_bounds();
+        }
+
+        std::size_t size() const {
+            return grid.size();
+        }
+
+        std::size_t stripe_count() const {
+            return stripes.size();
+        }
+
+    private:
+        static int check_stripe_width(int stripe_width) {
+            if (stripe_width < 1) {
+                throw std::invalid_argument("ConcurrentKDGrid: Stripe width must be positive, not " + std::to_string(stripe_width));
+            }
+            return stripe_width;
+        }
+
+        int stripe_of(int index) const {
+            return static_cast<int>((static_cast<long long>(index) - grid.get_bounds()[0]) / stripe_width);
+        }
+
+        /* atomic_ref needs a non-const object, even just to load. */
+        T& cell(const std::array<int, K>& indices) const {
+            return const_cast<KDGrid<T, K>&>(grid)[indices];
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_CONCURRENT_KD_GRID_H */
@@ -0,0 +1,259 @@
+/*
+ * kd_grid/double_buffered_kd_grid.h
+ *
+ * Two KDGrids of the same bounds for time stepped simulations: each step reads
+ * the current grid and writes the next one, then the two trade places in O(1).
+ * Nothing is allocated or copied between steps.
+ *
+ * Optionally, the grid is cut into tiles, and step() only visits tiles near ones
+ * that changed in the previous step. Quiet regions of a simulation then cost
+ * nothing.
+ */
+#ifndef jackcasey067_KD_GRID_DOUBLE_BUFFERED_KD_GRID_H
+#define jackcasey067_KD_GRID_DOUBLE_BUFFERED_KD_GRID_H
+
+#include "kd_grid.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Util {
+    template<typename T, int K>
+    class DoubleBufferedKDGrid {
+    private:
+        std::array<KDGrid<T, K>, 2> grids;
+        int current_index {0};
+
+        /* Tracking is off when tile_side is 0. */
+        int tile_side {0};
+
+        /* One cell per tile. changed is filled in by a step; active is what the next
+         * step visits. */
+        KDGrid<bool, K> changed;
+        KDGrid<bool, K> active;
+
+        /* Scratch for a step, kept so that steps allocate nothing: the active tiles
+         * in row-major order, and two masks for dilating active. */
+        std::vector<std::array<int, K>> tiles {};
+        KDGrid<bool, K> up;
+        KDGrid<bool, K> down;
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* Both grids start out filled with default_value. */
+        DoubleBufferedKDGrid(std::array<int, K*2> bounds, T default_value)
+            : grids {KDGrid<T, K> {bounds, default_value}, KDGrid<T, K> {bounds, default_value}},
+              changed {single_tile()}, active {single_tile(), true}, up {single_tile()}, down {single_tile()}
+        {}
+
+        DoubleBufferedKDGrid(std::array<int, K*2> bounds) requires std::default_initializable<T>
+            : DoubleBufferedKDGrid(bounds, {}) {}
+
+        /* Tracks changes in tiles with tile_side cells per side. A step's rule may read
+         * cells up to tile_side away from the one it computes. */
+        DoubleBufferedKDGrid(std::array<int, K*2> bounds, T default_value, int tile_side) requires std::equality_comparable<T>
+            : grids {KDGrid<T, K> {bounds, default_value}, KDGrid<T, K> {bounds, default_value}},
+              tile_side {tile_side}, changed {tile_bounds(bounds, tile_side)}, active {tile_bounds(bounds, tile_side), true},
+              up {tile_bounds(bounds, tile_side)}, down {tile_bounds(bounds, tile_side)}
+        {
+            tiles.reserve(active.size());
+        }
+
+        const KDGrid<T, K>& current() const {
+            return grids[current_index];
+        }
+
+        /* Writes here are not tracked, so swap() afterwards marks every tile active. */
+        KDGrid<T, K>& next() {
+            return grids[1 - current_index];
+        }
+
+        /* Makes next the current grid, after next() was written by hand. What was
+         * current becomes next, with its old contents. */
+        void swap() {
+            current_index = 1 - current_index;
+            active.fill(true);
+        }
+
+        /* Sets every cell of next to rule(current(), indices), then swaps. With
+         * tracking, only cells in active tiles are computed; the rest are left as
+         * they are, which is correct as long as rule gives the same result for the
+         * same neighbourhood. Tiles are spread across threads (0 meaning one per
+         * core), so rule must be safe to call concurrently. */
+        template<typename Rule>
+        void step(Rule rule, unsigned threads = 0) {
+            threads = __Util__Impl::output_threads<T, K>(__Util__Impl::thread_count(threads));
+
+            if constexpr (std::equality_comparable<T>) {
+                if (is_tracking()) {
+                    step_tiles(rule, threads);
+                    return;
+                }
+            }
+
+            const KDGrid<T, K>& from {grids[current_index]};
+            KDGrid<T, K>& to {grids[1 - current_index]};
+            const std::array<int, K*2>& bounds {from.get_bounds()};
+            __Util__Impl::parallel_for(bounds[0], bounds[1], threads, [&](unsigned, int first, int last) {
+                std::array<int, K> min {corner(bounds, 0)};
+                std::array<int, K> max {corner(bounds, 1)};
+                min[0] = first;
+                max[0] = last;
+                for_each_in_box(min, max, [&](const std::array<int, K>& indices) {
+                    to.get_unchecked(indices) = rule(from, indices);
+                });
+            });
+            current_index = 1 - current_index;
+        }
+
+        bool is_tracking() const {
+            return tile_side != 0;
+        }
+
+        int get_tile_side() const {
+            return tile_side;
+        }
+
+        /* The number of tiles the next step will visit. Without tracking, 1. */
+        std::size_t active_tile_count() const {
+            return active.count();
+        }
+
+        /* Makes the next step visit every tile, say after changing rules. */
+        void mark_all_active() {
+            active.fill(true);
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return grids[0].get_bounds();
+        }
+
+    private:
+        template<typename Rule>
+        void step_tiles(Rule& rule, unsigned threads) requires std::equality_comparable<T> {
+            const KDGrid<T, K>& from {grids[current_index]};
+            KDGrid<T, K>& to {grids[1 - current_index]};
+            const std::array<int, K*2>& bounds {from.get_bounds()};
+
+            tiles.clear();
+            for_each_in_box(corner(active.get_bounds(), 0), corner(active.get_bounds(), 1), [&](const std::array<int, K>& tile) {
+                if (active.get_unchecked(tile)) {
+                    tiles.push_back(tile);
+                }
+            });
+
+            auto visit {[&](const std::array<int, K>& tile) {
+                bool any_changed {false};
+                auto [min, max] {tile_box(tile, bounds)};
+                for_each_in_box(min, max, [&](const std::array<int, K>& indices) {
+                    T value (rule(from, indices));
+                    any_changed = any_changed || !(value == from.get_unchecked(indices));
+                    to.get_unchecked(indices) = std::move(value);
+                });
+                if (any_changed) {
+                    changed.atomic_test_and_set(tile);
+                }
+            }};
+
+            if constexpr (std::is_same_v<T, bool>) {
+                // Tiles side by side in a row of tiles share words of the bit packed
+                // grid, so threads take whole rows of tiles, which never do.
+                const std::array<int, K*2>& tile_bounds {active.get_bounds()};
+                __Util__Impl::parallel_for(tile_bounds[0], tile_bounds[1], threads, [&](unsigned, int first, int last) {
+                    auto by_row {[](const std::array<int, K>& tile, int row) { return tile[0] < row; }};
+                    auto begin {std::lower_bound(tiles.begin(), tiles.end(), first, by_row)};
+                    auto end {std::lower_bound(begin, tiles.end(), last + 1, by_row)};
+                    std::for_each(begin, end, visit);
+                });
+            }
+            else if (!tiles.empty()) {
+                __Util__Impl::parallel_for(0, static_cast<int>(tiles.size()) - 1, threads, [&](unsigned, int first, int last) {
+                    std::for_each(tiles.begin() + first, tiles.begin() + last + 1, visit);
+                });
+            }
+
+            // A changed tile can change its neighbours next step. Dilating by one
+            // tile in each dimension in turn covers diagonal neighbours too. Every
+            // tile where next is now stale is one that changed, so it is active,
+            // and will be rewritten before it is read. The grids all share bounds,
+            // so these assignments reuse their storage.
+            active = changed;
+            for (int d {0}; d < K; d++) {
+                up = active;
+                down = active;
+                up.shift(d, 1);
+                down.shift(d, -1);
+                active |= up;
+                active |= down;
+            }
+            changed.fill(false);
+            current_index = 1 - current_index;
+        }
+
+        static std::array<int, K*2> single_tile() {
+            return {};
+        }
+
+        static std::array<int, K*2> tile_bounds(const std::array<int, K*2>& bounds, int tile_side) {
+            if (tile_side < 1) {
+                throw std::invalid_argument("DoubleBufferedKDGrid: Tile side must be positive, not " + std::to_string(tile_side));
+            }
+            std::array<int, K*2> tiles;
+            for (int k {0}; k < K; k++) {
+                const long long extent {static_cast<long long>(bounds[2 * k+1]) - bounds[2 * k] + 1};
+                tiles[2 * k] = 0;
+                tiles[2 * k+1] = static_cast<int>((extent + tile_side - 1) / tile_side - 1);
+            }
+            return tiles;
+        }
+
+        /* The cells of a tile, clipped to the grid. */
+        std::pair<std::array<int, K>, std::array<int, K>> tile_box(const std::array<int, K>& tile, const std::array<int, K*2>& bounds) const {
+            std::array<int, K> min;
+            std::array<int, K> max;
+            for (int k {0}; k < K; k++) {
+                min[k] = bounds[2 * k] + tile[k] * tile_side;
+                max[k] = std::min(bounds[2 * k+1], min[k] + (tile_side - 1));
+            }
+            return {min, max};
+        }
+
+        /* The lower (side 0) or upper (side 1) corner of bounds. */
+        static std::array<int, K> corner(const std::array<int, K*2>& bounds, int side) {
+            std::array<int, K> indices;
+            for (int k {0}; k < K; k++) {
+                indices[k] = bounds[2 * k + side];
+            }
+            return indices;
+        }
+
+        template<typename Func>
+        static void for_each_in_box(const std::array<int, K>& min, const std::array<int, K>& max, Func func) {
+            std::array<int, K> indices {min};
+            while (true) {
+                func(std::as_const(indices));
+
+                int k {K - 1};
+                while (k >= 0 && indices[k] == max[k]) {
+                    indices[k] = min[k];
+                    k--;
+                }
+                if (k < 0) {
+                    return;
+                }
+                indices[k]++;
+            }
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_DOUBLE_BUFFERED_KD_GRID_H */
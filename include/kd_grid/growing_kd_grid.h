@@ -0,0 +1,177 @@
+/*
+ * kd_grid/growing_kd_grid.h
+ *
+ * A k dimension grid without fixed bounds. Writing outside the current bounds
+ * grows the grid to fit, keeping every cell at its indices. Growth is geometric
+ * in each direction, so like std::vector, it is amortized O(1).
+ */
+#ifndef jackcasey067_KD_GRID_GROWING_KD_GRID_H
+#define jackcasey067_KD_GRID_GROWING_KD_GRID_H
+
+#include "kd_grid.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <concepts>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace Util {
+    template<typename T, int K>
+    class GrowingKDGrid {
+    private:
+        T default_value;
+
+        /* The smallest box holding the initial bounds and every cell written since. */
+        std::array<int, K*2> bounds;
+
+        /* Covers bounds, with room to spare. */
+        KDGrid<T, K> grid;
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* What operator[] and get() hand out: T& and const T&, except for bool,
+         * whose grids are bit packed, where they are a proxy and a plain bool. */
+        using reference = decltype(std::declval<KDGrid<T, K>&>().get_unchecked(std::declval<const std::array<int, K>&>()));
+        using const_reference = std::conditional_t<std::is_same_v<T, bool>, bool, const T&>;
+
+        /* Starts out with the given inclusive bounds. Eg {{-10, 10, -10, 10}} */
+        GrowingKDGrid(std::array<int, K*2> initial_bounds, T default_value)
+            : default_value {default_value}, bounds {initial_bounds}, grid {initial_bounds, default_value}
+        {}
+
+        GrowingKDGrid(std::array<int, K*2> initial_bounds) requires std::default_initializable<T>
+            : GrowingKDGrid(initial_bounds, {}) {}
+
+        /* Starts out as the single cell at the origin. */
+        GrowingKDGrid(T default_value) : GrowingKDGrid(std::array<int, K*2> {}, default_value) {}
+
+        GrowingKDGrid() requires std::default_initializable<T> : GrowingKDGrid(T {}) {}
+
+        /* Never throws out_of_range; indices outside the bounds grow the grid. */
+        reference operator[](const std::array<int, K>& indices) {
+            if (!grid.in_bounds(indices)) {
+                grow_to(indices);
+            }
+            for (int k {0}; k < K; k++) {
+                bounds[2 * k] = std::min(bounds[2 * k], indices[k]);
+                bounds[2 * k+1] = std::max(bounds[2 * k+1], indices[k]);
+            }
+            return grid.get_unchecked(indices);
+        }
+
+        /* Read access. Never grows; cells outside the bounds are the default. */
+        const_reference get(const std::array<int, K>& indices) const {
+            if (!grid.in_bounds(indices)) {
+                return default_value;
+            }
+            return grid.get_unchecked(indices);
+        }
+
+        const_reference operator[](const std::array<int, K>& indices) const {
+            return get(indices);
+        }
+
+        /* Grows the grid so that it covers the given inclusive bounds, without moving
+         * cells again until they are exceeded. */
+        void reserve(const std::array<int, K*2>& reserved) {
+            std::array<int, K*2> capacity {grid.get_bounds()};
+            bool grow {false};
+            for (int k {0}; k < K; k++) {
+                grow = grow || reserved[2 * k] < capacity[2 * k] || reserved[2 * k+1] > capacity[2 * k+1];
+                capacity[2 * k] = std::min(capacity[2 * k], reserved[2 * k]);
+                capacity[2 * k+1] = std::max(capacity[2 * k+1], reserved[2 * k+1]);
+            }
+            if (grow) {
+                reallocate(capacity);
+            }
+        }
+
+        /* The smallest box containing the initial bounds and every cell written. */
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        /* The allocated box, which contains get_bounds(). */
+        const std::array<int, K*2>& get_capacity() const {
+            return grid.get_bounds();
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /* The underlying grid, for use with region() and friends. Cells outside
+         * get_bounds() hold the default. */
+        const KDGrid<T, K>& storage() const {
+            return grid;
+        }
+
+    private:
+        /* At least doubles the extent of each dimension that indices fall outside. */
+        void grow_to(const std::array<int, K>& indices) {
+            std::array<int, K*2> capacity {grid.get_bounds()};
+            for (int k {0}; k < K; k++) {
+                long long min {capacity[2 * k]};
+                long long max {capacity[2 * k+1]};
+                long long extent {max - min + 1};
+
+                if (indices[k] < min) {
+                    min = std::max<long long>(std::min<long long>(indices[k], min - extent), INT_MIN);
+                }
+                if (indices[k] > max) {
+                    max = std::min<long long>(std::max<long long>(indices[k], max + extent), INT_MAX);
+                }
+
+                capacity[2 * k] = static_cast<int>(min);
+                capacity[2 * k+1] = static_cast<int>(max);
+            }
+            reallocate(capacity);
+        }
+
+        void reallocate(const std::array<int, K*2>& capacity) {
+            KDGrid<T, K> larger {capacity, default_value};
+
+            if constexpr (std::is_same_v<T, bool>) {
+                // Rows of bits start at different offsets within the larger grid's
+                // words, so cells are copied one at a time.
+                const std::array<int, K*2>& old {grid.get_bounds()};
+                std::array<int, K> indices;
+                for (int k {0}; k < K; k++) {
+                    indices[k] = old[2 * k];
+                }
+                while (true) {
+                    larger.get_unchecked(indices) = static_cast<bool>(grid.get_unchecked(indices));
+
+                    int k {K - 1};
+                    while (k >= 0 && indices[k] == old[2 * k+1]) {
+                        indices[k] = old[2 * k];
+                        k--;
+                    }
+                    if (k < 0) {
+                        break;
+                    }
+                    indices[k]++;
+                }
+            }
+            else {
+                auto target {larger.region()};
+                grid.region().for_each_row([&target](const std::array<int, K>& first, std::span<T> row) {
+                    std::move(row.begin(), row.end(), &target[first]);
+                });
+            }
+
+            grid = std::move(larger);
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_GROWING_KD_GRID_H */
@@ -0,0 +1,568 @@
+/*
+ * kd_grid/kd_grid.h
+ *
+ * A template for a k dimension grid containing any data type.
+ *
+ * Prisms (boxes) of any dimension can be filled, or copied from one place to
+ * another, a whole row at a time with fill, copy_region, and blit.
+ */
+#ifndef jackcasey067_KD_GRID_KD_GRID_H
+#define jackcasey067_KD_GRID_KD_GRID_H
+
+#include "layouts.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        /* Above this many bytes, a buffer's first touch is split across threads, so
+         * each page is faulted in (and, on NUMA machines, placed) by a thread near
+         * the work that will use it. */
+        constexpr std::size_t parallel_touch_bytes {std::size_t {1} << 24};
+
+        /* One allocation holding every cell of a grid. This is nearly a std::vector,
+         * but we never need to grow, and allocating the cells ourselves lets us skip
+         * constructing them one by one.
+         *
+         * Trivially copyable cells come from calloc or malloc and are never
+         * constructed one by one. A default value of all zero bytes costs nothing up
+         * front: large callocs are fresh zero pages that the OS fills in on first
+         * touch. Other values are filled in by several threads for large buffers. */
+        template<typename T>
+        class CellBuffer {
+        private:
+            static constexpr bool from_malloc {std::is_trivially_copyable_v<T> && alignof(T) <= alignof(std::max_align_t)};
+
+            T* cells {nullptr};
+            std::size_t count {0};
+
+        public:
+            CellBuffer() = default;
+
+            CellBuffer(std::size_t count, const T& value) : count {count} {
+                if constexpr (from_malloc) {
+                    if (is_zero(value)) {
+                        cells = static_cast<T*>(checked(count == 0 ? nullptr : std::calloc(count, sizeof(T))));
+                    }
+                    else {
+                        cells = allocate(count);
+                        parallel_fill(value);
+                    }
+                }
+                else {
+                    cells = allocate(count);
+                    try {
+                        std::uninitialized_fill_n(cells, count, value);
+                    }
+                    catch (...) {
+                        deallocate(cells, count);
+                        throw;
+                    }
+                }
+            }
+
+            CellBuffer(const CellBuffer& other) : cells {allocate(other.count)}, count {other.count} {
+                if constexpr (from_malloc) {
+                    if (count != 0) {
+                        std::memcpy(static_cast<void*>(cells), static_cast<const void*>(other.cells), count * sizeof(T));
+                    }
+                }
+                else {
+                    try {
+                        std::uninitialized_copy_n(other.cells, count, cells);
+                    }
+                    catch (...) {
+                        deallocate(cells, count);
+                        throw;
+                    }
+                }
+            }
+
+            CellBuffer(CellBuffer&& other) noexcept
+                : cells {std::exchange(other.cells, nullptr)}, count {std::exchange(other.count, 0)}
+            {}
+
+            /* Copy and swap. */
+            CellBuffer& operator=(CellBuffer other) noexcept {
+                std::swap(cells, other.cells);
+                std::swap(count, other.count);
+                return *this;
+            }
+
+            ~CellBuffer() {
+                if (cells != nullptr) {
+                    std::destroy_n(cells, count);
+                    deallocate(cells, count);
+                }
+            }
+
+            T& operator[](std::size_t index) {
+                return cells[index];
+            }
+
+            const T& operator[](std::size_t index) const {
+                return cells[index];
+            }
+
+            T* data() {
+                return cells;
+            }
+
+            const T* data() const {
+                return cells;
+            }
+
+            std::size_t size() const {
+                return count;
+            }
+
+        private:
+            static T* allocate(std::size_t count) {
+                if (count == 0) {
+                    return nullptr;
+                }
+                if constexpr (from_malloc) {
+                    if (count > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+                        throw std::bad_array_new_length();
+                    }
+                    return static_cast<T*>(checked(std::malloc(count * sizeof(T))));
+                }
+                else {
+                    return std::allocator<T>().allocate(count);
+                }
+            }
+
+            static void deallocate(T* cells, std::size_t count) {
+                if constexpr (from_malloc) {
+                    std::free(cells);
+                }
+                else {
+                    std::allocator<T>().deallocate(cells, count);
+                }
+            }
+
+            static void* checked(void* memory) {
+                if (memory == nullptr) {
+                    throw std::bad_alloc();
+                }
+                return memory;
+            }
+
+            static bool is_zero(const T& value) {
+                std::array<unsigned char, sizeof(T)> bytes;
+                std::memcpy(bytes.data(), &value, sizeof(T));
+                return std::all_of(bytes.begin(), bytes.end(), [](unsigned char byte) { return byte == 0; });
+            }
+
+            /* Only for trivially copyable T, where filling cannot throw. */
+            void parallel_fill(const T& value) {
+                unsigned threads {count * sizeof(T) < parallel_touch_bytes ? 1 : thread_count(0)};
+                parallel_for(0, static_cast<int>(threads) - 1, threads, [this, &value, threads](unsigned, int first, int last) {
+                    std::size_t begin {count * first / threads};
+                    std::size_t end {count * (last + 1) / threads};
+                    std::uninitialized_fill(cells + begin, cells + end, value);
+                });
+            }
+        };
+
+        /* Sets count cells from first to value. A value whose bytes are all the same
+         * (zero, most often) is one memset; otherwise fill_n, which compilers turn
+         * into broadcast vector stores for simple types. */
+        template<typename T>
+        void fill_run(T* first, std::size_t count, const T& value) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                std::array<unsigned char, sizeof(T)> bytes;
+                std::memcpy(bytes.data(), &value, sizeof(T));
+                if (std::all_of(bytes.begin(), bytes.end(), [&bytes](unsigned char byte) { return byte == bytes[0]; })) {
+                    std::memset(static_cast<void*>(first), bytes[0], count * sizeof(T));
+                    return;
+                }
+            }
+            std::fill_n(first, count, value);
+        }
+
+        /* Copies count cells from from to to. The runs may overlap. */
+        template<typename T>
+        void copy_run(const T* from, std::size_t count, T* to) {
+            if constexpr (std::is_trivially_copyable_v<T>) {
+                std::memmove(static_cast<void*>(to), static_cast<const void*>(from), count * sizeof(T));
+            }
+            else if (std::less<const T*>()(from, to)) {
+                std::copy_backward(from, from + count, to + count);
+            }
+            else {
+                std::copy_n(from, count, to);
+            }
+        }
+    }
+
+    /* Layout decides where cells live in memory (see layouts.h). The default, row
+     * major, is the only one with contiguous rows; the others trade that for
+     * locality in every dimension. */
+    template<typename T, int K, typename Layout = RowMajorLayout>
+    class KDGrid {
+        static_assert(K >= 1, "KDGrid needs at least one dimension.");
+
+    private:
+        std::array<int, K*2> bounds; // min1, max1, min2, max2, ...
+
+        /* Cells live in one buffer, at the offsets given by the layout. */
+        typename Layout::template Mapping<K> mapping;
+
+        __Util__Impl::CellBuffer<T> cells;
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* Takes an array of the inclusive bounds in order. Eg {{-10, 10, -10, 10}}*/
+        KDGrid(std::array<int, K*2> bounds, T default_value)
+            : bounds {bounds}, mapping {bounds}, cells {mapping.size(), default_value}
+        {}
+
+        KDGrid(std::array<int, K*2> bounds) requires std::default_initializable<T>
+            : KDGrid(bounds, {}) {}
+
+        /* A hyper-rectangle of the grid whose bounds were checked when it was made,
+         * so access inside it is unchecked. Obtained from region(). Const selects
+         * read only access. Invalidated along with the grid. */
+        template<bool Const>
+        class BasicRegion {
+        private:
+            using Grid = std::conditional_t<Const, const KDGrid, KDGrid>;
+            using Cell = std::conditional_t<Const, const T, T>;
+
+            Grid* grid;
+            std::array<int, K> min;
+            std::array<int, K> max;
+
+            BasicRegion(Grid* grid, std::array<int, K> min, std::array<int, K> max)
+                : grid {grid}, min {min}, max {max} {}
+
+            friend class KDGrid;
+
+        public:
+            /* No bounds checking. Indices are the same as the grid's, not relative
+             * to the region. */
+            Cell& operator[](const std::array<int, K>& indices) const {
+                return grid->get_unchecked(indices);
+            }
+
+            const std::array<int, K>& get_min() const {
+                return min;
+            }
+
+            const std::array<int, K>& get_max() const {
+                return max;
+            }
+
+            std::size_t size() const {
+                std::size_t count {1};
+                for (int k {0}; k < K; k++) {
+                    count *= static_cast<std::size_t>(max[k] - min[k] + 1);
+                }
+                return count;
+            }
+
+            /* Calls func(first, row) for each run of cells along the last dimension,
+             * where first is the indices of row[0]. This is the fast way through a
+             * region; row is contiguous memory. */
+            template<typename Func>
+            void for_each_row(Func func) const requires Layout::is_row_major {
+                std::array<int, K> indices {min};
+                const std::size_t length {static_cast<std::size_t>(max[K - 1] - min[K - 1] + 1)};
+                while (true) {
+                    func(std::as_const(indices), std::span<Cell>(&grid->get_unchecked(indices), length));
+
+                    int k {K - 2};
+                    while (k >= 0 && indices[k] == max[k]) {
+                        indices[k] = min[k];
+                        k--;
+                    }
+                    if (k < 0) {
+                        return;
+                    }
+                    indices[k]++;
+                }
+            }
+
+            /* Calls func(indices, cell) for every cell, with the last dimension
+             * innermost (which is memory order for row major grids). */
+            template<typename Func>
+            void for_each(Func func) const {
+                if constexpr (Layout::is_row_major) {
+                    for_each_row([&func](std::array<int, K> indices, std::span<Cell> row) {
+                        for (Cell& cell : row) {
+                            func(std::as_const(indices), cell);
+                            indices[K - 1]++;
+                        }
+                    });
+                }
+                else {
+                    std::array<int, K> indices {min};
+                    while (true) {
+                        func(std::as_const(indices), grid->get_unchecked(indices));
+
+                        int k {K - 1};
+                        while (k >= 0 && indices[k] == max[k]) {
+                            indices[k] = min[k];
+                            k--;
+                        }
+                        if (k < 0) {
+                            return;
+                        }
+                        indices[k]++;
+                    }
+                }
+            }
+        };
+
+        using Region = BasicRegion<false>;
+        using ConstRegion = BasicRegion<true>;
+
+        T& operator[](const std::array<int, K>& indices) {
+            return cells[checked_offset(indices)];
+        }
+
+        const T& operator[](const std::array<int, K>& indices) const {
+            return cells[checked_offset(indices)];
+        }
+
+        /* Skips the bounds check. Out of bounds indices are undefined behavior. */
+        T& get_unchecked(const std::array<int, K>& indices) {
+            return cells[offset(indices)];
+        }
+
+        const T& get_unchecked(const std::array<int, K>& indices) const {
+            return cells[offset(indices)];
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /* The inclusive bounds, in the order given to the constructor. */
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        /* The number of cells. Some layouts allocate a few more than this. */
+        std::size_t size() const {
+            std::size_t count {1};
+            for (int k {0}; k < K; k++) {
+                count *= static_cast<std::size_t>(static_cast<std::ptrdiff_t>(bounds[2 * k+1]) - bounds[2 * k] + 1);
+            }
+            return count;
+        }
+
+        /* How far apart, in cells, neighbours along each dimension are in memory. */
+        const std::array<std::ptrdiff_t, K>& get_strides() const requires Layout::is_row_major {
+            return mapping.get_strides();
+        }
+
+        /* Every cell, padding included, in the order the layout stores them. For
+         * bulk IO; see mapped_kd_grid.h. */
+        std::span<T> buffer() {
+            return {cells.data(), cells.size()};
+        }
+
+        std::span<const T> buffer() const {
+            return {cells.data(), cells.size()};
+        }
+
+        /* Sets every cell to value. */
+        void fill(const T& value) {
+            __Util__Impl::fill_run(cells.data(), cells.size(), value);
+        }
+
+        /* Sets every cell in the inclusive box from min to max to value. */
+        void fill(const std::array<int, K>& min, const std::array<int, K>& max, const T& value) {
+            if constexpr (Layout::is_row_major) {
+                region(min, max).for_each_row([&value](const std::array<int, K>&, std::span<T> row) {
+                    __Util__Impl::fill_run(row.data(), row.size(), value);
+                });
+            }
+            else {
+                region(min, max).for_each([&value](const std::array<int, K>&, T& cell) {
+                    cell = value;
+                });
+            }
+        }
+
+        /* Copies the inclusive box from min to max of source into this grid, so that
+         * source's min lands on to. Source may be this grid, and the two boxes may
+         * overlap; the result is as if the box were copied out first. */
+        void copy_region(const KDGrid& source, const std::array<int, K>& min, const std::array<int, K>& max,
+                const std::array<int, K>& to) {
+            source.check_region(min, max);
+            std::array<int, K> to_max;
+            for (int k {0}; k < K; k++) {
+                to_max[k] = to[k] + (max[k] - min[k]);
+            }
+            check_region(to, to_max);
+
+            auto destination = [&min, &to](const std::array<int, K>& from) {
+                std::array<int, K> indices;
+                for (int k {0}; k < K; k++) {
+                    indices[k] = to[k] + (from[k] - min[k]);
+                }
+                return indices;
+            };
+
+            if constexpr (Layout::is_row_major) {
+                // Rows are a whole grid row apart, so overlapping boxes are safe as
+                // long as no row is overwritten before it is read. Walking the rows
+                // away from the destination ensures that.
+                const std::size_t length {static_cast<std::size_t>(max[K - 1] - min[K - 1] + 1)};
+                const bool backwards {&source == this && offset(to) > offset(min)};
+                for_each_row_start(min, max, backwards, [&](const std::array<int, K>& from) {
+                    __Util__Impl::copy_run(&source.get_unchecked(from), length, &get_unchecked(destination(from)));
+                });
+            }
+            else if (&source == this) {
+                // No useful order exists for other layouts, so go through a copy.
+                std::vector<T> staged;
+                staged.reserve(source.region(min, max).size());
+                source.region(min, max).for_each([&staged](const std::array<int, K>&, const T& cell) {
+                    staged.push_back(cell);
+                });
+                std::size_t i {0};
+                region(to, to_max).for_each([&staged, &i](const std::array<int, K>&, T& cell) {
+                    cell = std::move(staged[i++]);
+                });
+            }
+            else {
+                source.region(min, max).for_each([&](const std::array<int, K>& from, const T& cell) {
+                    get_unchecked(destination(from)) = cell;
+                });
+            }
+        }
+
+        /* Copies all of source into this grid, with source's lower corner landing on
+         * to. Source's bounds need not match this grid's. */
+        void blit(const KDGrid& source, const std::array<int, K>& to) {
+            copy_region(source, source.lower_corner(), source.upper_corner(), to);
+        }
+
+        /* Checks once that the inclusive box from min to max lies in the grid, and
+         * returns unchecked access to it. */
+        Region region(const std::array<int, K>& min, const std::array<int, K>& max) {
+            check_region(min, max);
+            return Region(this, min, max);
+        }
+
+        ConstRegion region(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            check_region(min, max);
+            return ConstRegion(this, min, max);
+        }
+
+        /* The whole grid. */
+        Region region() {
+            return Region(this, lower_corner(), upper_corner());
+        }
+
+        ConstRegion region() const {
+            return ConstRegion(this, lower_corner(), upper_corner());
+        }
+
+    private:
+        std::size_t offset(const std::array<int, K>& indices) const {
+            return mapping.offset(indices);
+        }
+
+        std::size_t checked_offset(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+            return mapping.offset(indices);
+        }
+
+        void check_region(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            for (int k {0}; k < K; k++) {
+                if (min[k] > max[k]) {
+                    throw std::invalid_argument("KDGrid: Region is empty in the " + std::to_string(k + 1) + "'th dimension.");
+                }
+                if (min[k] < bounds[2 * k]) {
+                    throw_out_of_range(k, min[k]);
+                }
+                if (max[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, max[k]);
+                }
+            }
+        }
+
+        /* Kept out of line so that the message building does not crowd the hot path. */
+        [[noreturn, gnu::cold, gnu::noinline]] void throw_out_of_range(int k, int index) const {
+            throw std::out_of_range("KDGrid: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+
+        /* Calls func(first) with the indices of the start of each row of the box,
+         * in memory order, or the reverse if backwards. */
+        template<typename Func>
+        static void for_each_row_start(const std::array<int, K>& min, const std::array<int, K>& max, bool backwards, Func func) {
+            const std::array<int, K>& start {backwards ? max : min};
+            const std::array<int, K>& end {backwards ? min : max};
+            const int step {backwards ? -1 : 1};
+
+            std::array<int, K> indices {start};
+            indices[K - 1] = min[K - 1];
+            while (true) {
+                func(std::as_const(indices));
+
+                int k {K - 2};
+                while (k >= 0 && indices[k] == end[k]) {
+                    indices[k] = start[k];
+                    k--;
+                }
+                if (k < 0) {
+                    return;
+                }
+                indices[k] += step;
+            }
+        }
+
+        std::array<int, K> lower_corner() const {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = bounds[2 * k];
+            }
+            return corner;
+        }
+
+        std::array<int, K> upper_corner() const {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = bounds[2 * k+1];
+            }
+            return corner;
+        }
+    };
+}
+
+/* The bit packed specialization has to be visible wherever the primary template is. */
+#include "bool_kd_grid.h"
+
+#endif /* jackcasey067_KD_GRID_KD_GRID_H */
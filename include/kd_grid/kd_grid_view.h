@@ -0,0 +1,244 @@
+/*
+ * kd_grid/kd_grid_view.h
+ *
+ * A non owning view of (part of) a KDGrid, in the style of std::mdspan. Views
+ * share the grid's cells, so handing a piece of a grid to another routine costs
+ * nothing. A view can be narrowed to a box, strided, sliced down a dimension, or
+ * have its dimensions reordered, each in O(K) and without touching any cells.
+ *
+ * Like a pointer, a view is invalidated when its grid is destroyed, and does not
+ * keep the grid alive.
+ */
+#ifndef jackcasey067_KD_GRID_KD_GRID_VIEW_H
+#define jackcasey067_KD_GRID_KD_GRID_VIEW_H
+
+#include "kd_grid.h"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Util {
+    /* T may be const, for a read only view. Bit packed KDGrid<bool, K> cells have
+     * no addresses, so there are no views of them. */
+    template<typename T, int K>
+        requires (!std::is_same_v<std::remove_const_t<T>, bool>)
+    class KDGridView {
+        static_assert(K >= 1, "KDGridView needs at least one dimension.");
+
+    private:
+        T* first; // The cell at the lower corner.
+        std::array<int, K*2> bounds; // min1, max1, min2, max2, ...
+        std::array<std::ptrdiff_t, K> strides;
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* A view of the whole grid, with the same indices. */
+        KDGridView(KDGrid<std::remove_const_t<T>, K>& grid)
+            : KDGridView(grid_first(grid), grid.get_bounds(), grid.get_strides()) {}
+
+        KDGridView(const KDGrid<std::remove_const_t<T>, K>& grid) requires std::is_const_v<T>
+            : KDGridView(grid_first(grid), grid.get_bounds(), grid.get_strides()) {}
+
+        /* A view of arbitrary memory: the cell at indices is
+         * first[sum((indices[k] - min_k) * strides[k])]. */
+        KDGridView(T* first, const std::array<int, K*2>& bounds, const std::array<std::ptrdiff_t, K>& strides)
+            : first {first}, bounds {bounds}, strides {strides} {}
+
+        /* Mutable views convert to read only views. */
+        operator KDGridView<const T, K>() const requires (!std::is_const_v<T>) {
+            return KDGridView<const T, K>(first, bounds, strides);
+        }
+
+        T& operator[](const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+            return get_unchecked(indices);
+        }
+
+        /* Skips the bounds check. Out of bounds indices are undefined behavior. */
+        T& get_unchecked(const std::array<int, K>& indices) const {
+            std::ptrdiff_t offset {0};
+            for (int k {0}; k < K; k++) {
+                offset += (indices[k] - bounds[2 * k]) * strides[k];
+            }
+            return first[offset];
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        const std::array<std::ptrdiff_t, K>& get_strides() const {
+            return strides;
+        }
+
+        std::size_t size() const {
+            std::size_t count {1};
+            for (int k {0}; k < K; k++) {
+                count *= static_cast<std::size_t>(bounds[2 * k+1] - bounds[2 * k] + 1);
+            }
+            return count;
+        }
+
+        /* Whether the cells along the last dimension are adjacent in memory. */
+        bool has_contiguous_rows() const {
+            return strides[K - 1] == 1;
+        }
+
+        /* The inclusive box from min to max, which keeps the same indices. */
+        KDGridView subview(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            for (int k {0}; k < K; k++) {
+                if (min[k] > max[k]) {
+                    throw std::invalid_argument("KDGridView: Subview is empty in the " + std::to_string(k + 1) + "'th dimension.");
+                }
+            }
+            KDGridView view {&(*this)[min], bounds, strides};
+            (*this)[max]; // Bounds check.
+            for (int k {0}; k < K; k++) {
+                view.bounds[2 * k] = min[k];
+                view.bounds[2 * k+1] = max[k];
+            }
+            return view;
+        }
+
+        /* Every step'th cell along dimension (0 indexed), starting from the min. The
+         * min stays put, and index min + j of the result is index min + j * step of
+         * this view. */
+        KDGridView strided(int dimension, int step) const {
+            check_dimension(dimension);
+            if (step < 1) {
+                throw std::invalid_argument("KDGridView: Stride must be positive, not " + std::to_string(step));
+            }
+            KDGridView view {*this};
+            int min {bounds[2 * dimension]};
+            view.bounds[2 * dimension+1] = min + (bounds[2 * dimension+1] - min) / step;
+            view.strides[dimension] *= step;
+            return view;
+        }
+
+        /* The K-1 dimension view where dimension (0 indexed) is fixed at index. */
+        KDGridView<T, K - 1> slice(int dimension, int index) const requires (K > 1) {
+            check_dimension(dimension);
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = bounds[2 * k];
+            }
+            corner[dimension] = index;
+
+            std::array<int, K*2 - 2> sliced_bounds;
+            std::array<std::ptrdiff_t, K - 1> sliced_strides;
+            for (int k {0}, j {0}; k < K; k++) {
+                if (k != dimension) {
+                    sliced_bounds[2 * j] = bounds[2 * k];
+                    sliced_bounds[2 * j+1] = bounds[2 * k+1];
+                    sliced_strides[j] = strides[k];
+                    j++;
+                }
+            }
+            return KDGridView<T, K - 1>(&(*this)[corner], sliced_bounds, sliced_strides);
+        }
+
+        /* Reorders the dimensions: dimension d of the result is dimension order[d]
+         * of this view. Eg {1, 0} is a transpose. */
+        KDGridView transpose(const std::array<int, K>& order) const {
+            std::array<bool, K> seen {};
+            KDGridView view {*this};
+            for (int d {0}; d < K; d++) {
+                check_dimension(order[d]);
+                if (seen[order[d]]) {
+                    throw std::invalid_argument("KDGridView: Transpose order must be a permutation.");
+                }
+                seen[order[d]] = true;
+
+                view.bounds[2 * d] = bounds[2 * order[d]];
+                view.bounds[2 * d+1] = bounds[2 * order[d]+1];
+                view.strides[d] = strides[order[d]];
+            }
+            return view;
+        }
+
+        /* Calls func(indices, cell) for every cell, with the last dimension innermost. */
+        template<typename Func>
+        void for_each(Func func) const {
+            std::array<int, K> indices;
+            for (int k {0}; k < K; k++) {
+                indices[k] = bounds[2 * k];
+            }
+
+            while (true) {
+                T* cell {&get_unchecked(indices)};
+                for (int i {bounds[2 * K - 2]}; i <= bounds[2 * K - 1]; i++) {
+                    indices[K - 1] = i;
+                    func(std::as_const(indices), *cell);
+                    cell += strides[K - 1];
+                }
+
+                int k {K - 2};
+                while (k >= 0 && indices[k] == bounds[2 * k+1]) {
+                    indices[k] = bounds[2 * k];
+                    k--;
+                }
+                if (k < 0) {
+                    return;
+                }
+                indices[k]++;
+                indices[K - 1] = bounds[2 * K - 2];
+            }
+        }
+
+        /* Copies the viewed cells into a new grid with the view's bounds. */
+        KDGrid<std::remove_const_t<T>, K> to_grid() const requires std::default_initializable<std::remove_const_t<T>> {
+            KDGrid<std::remove_const_t<T>, K> grid {bounds};
+            for_each([&grid](const std::array<int, K>& indices, const T& cell) {
+                grid.get_unchecked(indices) = cell;
+            });
+            return grid;
+        }
+
+    private:
+        template<typename Grid>
+        static T* grid_first(Grid& grid) {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = grid.get_bounds()[2 * k];
+            }
+            return &grid.get_unchecked(corner);
+        }
+
+        void check_dimension(int dimension) const {
+            if (dimension < 0 || dimension >= K) {
+                throw std::invalid_argument("KDGridView: There is no dimension " + std::to_string(dimension));
+            }
+        }
+
+        [[noreturn, gnu::cold, gnu::noinline]] void throw_out_of_range(int k, int index) const {
+            throw std::out_of_range("KDGridView: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+    };
+
+    template<typename T, int K>
+    KDGridView(KDGrid<T, K>&) -> KDGridView<T, K>;
+
+    template<typename T, int K>
+    KDGridView(const KDGrid<T, K>&) -> KDGridView<const T, K>;
+}
+
+#endif /* jackcasey067_KD_GRID_KD_GRID_VIEW_H */
@@ -0,0 +1,204 @@
+/*
+ * kd_grid/layouts.h
+ *
+ * Memory layouts for KDGrid, chosen by its Layout template parameter. Indexing a
+ * grid looks the same whatever the layout; the layout only decides where each
+ * cell sits in the buffer.
+ *
+ * A layout is a type with
+ *   - static constexpr bool is_row_major, true if the last dimension is contiguous
+ *     and neighbours are a fixed stride apart (which is what Region::for_each_row,
+ *     KDGrid::get_strides, views, and the parallel operations rely on).
+ *   - template<int K> class Mapping, constructible from the grid's bounds, with
+ *     size() (the number of cells to allocate, which may include padding) and
+ *     offset(indices) (where the in bounds cell at indices lives).
+ *   - static constexpr std::uint64_t id, different for every layout, which saved
+ *     grids record so that they are never reopened with the wrong layout.
+ */
+#ifndef jackcasey067_KD_GRID_LAYOUTS_H
+#define jackcasey067_KD_GRID_LAYOUTS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        inline void check_bounds_order(const int* bounds, int K) {
+            for (int k {0}; k < K; k++) {
+                if (bounds[2 * k+1] < bounds[2 * k]) {
+                    throw std::invalid_argument("KDGrid: In the " + std::to_string(k + 1) + "'th dimension, max "
+                        + std::to_string(bounds[2 * k+1]) + " is less than min " + std::to_string(bounds[2 * k]));
+                }
+            }
+        }
+
+        /* A mapping where the offset is a sum of one table lookup per dimension. Both
+         * Morton order and tiling can be written this way, which keeps indexing to K
+         * loads and adds no matter how the bits get shuffled. */
+        template<int K>
+        class SeparableMapping {
+        protected:
+            std::array<int, K> min;
+            std::array<std::vector<std::size_t>, K> tables;
+            std::size_t cell_count {0};
+
+            SeparableMapping(const std::array<int, K*2>& bounds) {
+                check_bounds_order(bounds.data(), K);
+                for (int k {0}; k < K; k++) {
+                    min[k] = bounds[2 * k];
+                    tables[k].resize(static_cast<std::size_t>(static_cast<long long>(bounds[2 * k+1]) - bounds[2 * k] + 1));
+                }
+            }
+
+        public:
+            std::size_t size() const {
+                return cell_count;
+            }
+
+            std::size_t offset(const std::array<int, K>& indices) const {
+                std::size_t offset {0};
+                for (int k {0}; k < K; k++) {
+                    offset += tables[k][static_cast<std::size_t>(indices[k] - min[k])];
+                }
+                return offset;
+            }
+        };
+    }
+
+    /* The default. The last dimension is contiguous, then the second to last, etc. */
+    struct RowMajorLayout {
+        static constexpr bool is_row_major {true};
+        static constexpr std::uint64_t id {0};
+
+        template<int K>
+        class Mapping {
+        private:
+            /* The cell at indices lives at sum(indices[k] * strides[k]) - origin. */
+            std::array<std::ptrdiff_t, K> strides;
+            std::ptrdiff_t origin {0};
+            std::size_t cell_count {1};
+
+        public:
+            Mapping(const std::array<int, K*2>& bounds) {
+                __Util__Impl::check_bounds_order(bounds.data(), K);
+
+                std::ptrdiff_t stride {1};
+                for (int k {K - 1}; k >= 0; k--) {
+                    strides[k] = stride;
+                    stride *= static_cast<std::ptrdiff_t>(bounds[2 * k+1]) - bounds[2 * k] + 1;
+                }
+                cell_count = static_cast<std::size_t>(stride);
+
+                for (int k {0}; k < K; k++) {
+                    origin += bounds[2 * k] * strides[k];
+                }
+            }
+
+            std::size_t size() const {
+                return cell_count;
+            }
+
+            std::size_t offset(const std::array<int, K>& indices) const {
+                std::ptrdiff_t offset {-origin};
+                for (int k {0}; k < K; k++) {
+                    offset += indices[k] * strides[k];
+                }
+                return static_cast<std::size_t>(offset);
+            }
+
+            const std::array<std::ptrdiff_t, K>& get_strides() const {
+                return strides;
+            }
+        };
+    };
+
+    /* Z-order. The bits of each (zero based) index are interleaved, so cells that
+     * are close in every dimension are close in memory, and a cube of side 2^n is
+     * one contiguous block. Each dimension is padded to a power of two, so a
+     * lopsided grid can use up to 2^K times its cell count. */
+    struct MortonLayout {
+        static constexpr bool is_row_major {false};
+        static constexpr std::uint64_t id {1};
+
+        template<int K>
+        class Mapping : public __Util__Impl::SeparableMapping<K> {
+        public:
+            Mapping(const std::array<int, K*2>& bounds) : __Util__Impl::SeparableMapping<K>(bounds) {
+                std::array<int, K> bits;
+                int max_bits {0};
+                int total_bits {0};
+                for (int k {0}; k < K; k++) {
+                    bits[k] = std::bit_width(this->tables[k].size() - 1);
+                    max_bits = std::max(max_bits, bits[k]);
+                    total_bits += bits[k];
+                }
+                if (total_bits >= static_cast<int>(sizeof(std::size_t) * 8)) {
+                    throw std::length_error("KDGrid: Grid is too large for a Morton layout.");
+                }
+                this->cell_count = std::size_t {1} << total_bits;
+
+                // Deal out output bits round robin, with the last dimension lowest.
+                std::array<std::vector<int>, K> positions;
+                for (int b {0}, position {0}; b < max_bits; b++) {
+                    for (int k {K - 1}; k >= 0; k--) {
+                        if (b < bits[k]) {
+                            positions[k].push_back(position++);
+                        }
+                    }
+                }
+
+                for (int k {0}; k < K; k++) {
+                    for (std::size_t i {0}; i < this->tables[k].size(); i++) {
+                        std::size_t spread {0};
+                        for (int b {0}; b < bits[k]; b++) {
+                            spread |= ((i >> b) & 1) << positions[k][b];
+                        }
+                        this->tables[k][i] = spread;
+                    }
+                }
+            }
+        };
+    };
+
+    /* The grid is cut into cubes of Side cells per dimension. The tiles are stored
+     * one after another in row major order, and each tile is row major inside. The
+     * grid is padded up to a whole number of tiles. */
+    template<int Side>
+    struct TiledLayout {
+        static_assert(Side >= 1, "TiledLayout needs a positive tile side.");
+
+        static constexpr bool is_row_major {false};
+        static constexpr std::uint64_t id {2 | static_cast<std::uint64_t>(Side) << 8};
+
+        template<int K>
+        class Mapping : public __Util__Impl::SeparableMapping<K> {
+        public:
+            Mapping(const std::array<int, K*2>& bounds) : __Util__Impl::SeparableMapping<K>(bounds) {
+                std::size_t tile_cells {1};
+                for (int k {0}; k < K; k++) {
+                    tile_cells *= Side;
+                }
+
+                std::size_t tile_stride {tile_cells}; // In cells, between neighbouring tiles.
+                std::size_t inner_stride {1}; // In cells, between neighbours within a tile.
+                for (int k {K - 1}; k >= 0; k--) {
+                    std::vector<std::size_t>& table {this->tables[k]};
+                    for (std::size_t i {0}; i < table.size(); i++) {
+                        table[i] = (i / Side) * tile_stride + (i % Side) * inner_stride;
+                    }
+                    tile_stride *= (table.size() + Side - 1) / Side;
+                    inner_stride *= Side;
+                }
+                this->cell_count = tile_stride;
+            }
+        };
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_LAYOUTS_H */
@@ -0,0 +1,49 @@
+/*
+ * kd_grid/mapped_file.h
+ *
+ * A whole file mapped into memory with mmap, which is what MappedKDGrid is built
+ * on. Pages are read in by the OS as they are first touched, and are shared with
+ * the page cache, so opening a file costs nothing up front however large it is.
+ * POSIX only.
+ */
+#ifndef jackcasey067_KD_GRID_MAPPED_FILE_H
+#define jackcasey067_KD_GRID_MAPPED_FILE_H
+
+#include <base_classes/noncopyable.h>
+
+#include <cstddef>
+#include <string>
+
+
+namespace Util {
+    enum class MapMode {
+        ReadOnly,    // Writing to the memory is a crash.
+        CopyOnWrite, // Writes go to private copies of the pages they touch, never to the file.
+    };
+
+    /* Unmaps the file on destruction. Throws std::system_error if the file cannot be
+     * opened or mapped. */
+    class MappedFile : public NonCopyable {
+    public:
+        MappedFile(const std::string& path, MapMode mode);
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        ~MappedFile();
+
+        /* Null for an empty file. */
+        std::byte* data();
+        const std::byte* data() const;
+
+        std::size_t size() const;
+        MapMode get_mode() const;
+
+    private:
+        std::byte* memory {nullptr};
+        std::size_t length {0};
+        MapMode mode;
+
+        void unmap();
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_MAPPED_FILE_H */
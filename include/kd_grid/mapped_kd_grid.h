@@ -0,0 +1,251 @@
+/*
+ * kd_grid/mapped_kd_grid.h
+ *
+ * A binary file format for KDGrid, and MappedKDGrid, which opens such a file with
+ * mmap instead of reading it. The cells in the file are exactly the grid's buffer,
+ * so opening is O(1) and the only reading done is the OS paging in what is used.
+ *
+ * The format is a header (see GridFileHeader), the bounds as K*2 int32s, zero
+ * padding up to a page boundary, then the buffer. It is not portable between
+ * machines of different byte order, or between builds where T differs; the header
+ * records enough (byte order, size and alignment of T, K, layout) to refuse the
+ * obvious mistakes, but not to tell two types of the same size apart.
+ */
+#ifndef jackcasey067_KD_GRID_MAPPED_KD_GRID_H
+#define jackcasey067_KD_GRID_MAPPED_KD_GRID_H
+
+#include "kd_grid.h"
+#include "kd_grid_view.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        /* The data section starts on a boundary this large, so cells in the mapping
+         * are aligned for any T, and whole pages of cells can be mapped. */
+        constexpr std::uint64_t grid_file_alignment {4096};
+
+        constexpr std::array<char, 8> grid_file_magic {'K', 'D', 'G', 'R', 'I', 'D', '\0', '\1'};
+
+        /* Written as the saving machine lays it out in memory. */
+        constexpr std::uint32_t grid_file_byte_order {0x01020304};
+
+        struct GridFileHeader {
+            std::array<char, 8> magic;
+            std::uint32_t byte_order;
+            std::uint32_t element_size;
+            std::uint32_t element_align;
+            std::int32_t dimensions;
+            std::uint64_t layout;
+            std::uint64_t data_offset; // From the start of the file.
+            std::uint64_t cell_count;  // In the buffer, including layout padding.
+        };
+
+        template<typename T>
+        concept MappableCell = std::is_trivially_copyable_v<T> && !std::same_as<T, bool>
+            && alignof(T) <= grid_file_alignment;
+
+        template<int K>
+        std::uint64_t grid_file_data_offset() {
+            const std::uint64_t end {sizeof(GridFileHeader) + sizeof(std::int32_t) * K * 2};
+            return (end + grid_file_alignment - 1) / grid_file_alignment * grid_file_alignment;
+        }
+
+        [[noreturn]] inline void throw_bad_grid_file(const std::string& path, const std::string& problem) {
+            throw std::runtime_error("MappedKDGrid: " + path + " " + problem);
+        }
+    }
+
+    /* Writes grid to path in the format MappedKDGrid reads, replacing any file
+     * already there. Throws std::runtime_error if the file cannot be written. */
+    template<__Util__Impl::MappableCell T, int K, typename Layout>
+    void save_grid(const KDGrid<T, K, Layout>& grid, const std::string& path) {
+        using namespace __Util__Impl;
+
+        const std::span<const T> buffer {grid.buffer()};
+        const GridFileHeader header {
+            grid_file_magic, grid_file_byte_order, sizeof(T), alignof(T), K, Layout::id,
+            grid_file_data_offset<K>(), buffer.size()
+        };
+
+        std::array<std::int32_t, K*2> bounds;
+        std::copy(grid.get_bounds().begin(), grid.get_bounds().end(), bounds.begin());
+
+        const std::vector<char> padding (header.data_offset - sizeof(header) - sizeof(bounds), '\0');
+
+        std::ofstream out {path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(bounds.data()), sizeof(bounds));
+        out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+        out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size_bytes()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("save_grid: Could not write " + path);
+        }
+    }
+
+    /* A grid saved by save_grid, used in place in the mapped file. The T, K and
+     * Layout must be the ones it was saved with (which is checked, as far as the
+     * file can tell).
+     *
+     * In ReadOnly mode, there are only const accessors, so reads work on any grid
+     * and writes do not compile. In CopyOnWrite mode, writes are private to this
+     * object; save_grid(to_grid(), ...) to keep them. */
+    template<__Util__Impl::MappableCell T, int K, typename Layout = RowMajorLayout, MapMode Mode = MapMode::ReadOnly>
+    class MappedKDGrid {
+        static_assert(K >= 1, "MappedKDGrid needs at least one dimension.");
+
+    private:
+        MappedFile file;
+        std::array<int, K*2> bounds;
+        typename Layout::template Mapping<K> mapping;
+        T* cells;
+
+    public:
+        static constexpr int dimensions {K};
+        static constexpr bool writable {Mode != MapMode::ReadOnly};
+
+        MappedKDGrid(const std::string& path)
+            : file {path, Mode}, bounds {read_bounds(file, path)}, mapping {bounds},
+              cells {reinterpret_cast<T*>(file.data() + __Util__Impl::grid_file_data_offset<K>())}
+        {
+            const auto* header {reinterpret_cast<const __Util__Impl::GridFileHeader*>(file.data())};
+            if (header->cell_count != mapping.size()) {
+                __Util__Impl::throw_bad_grid_file(path, "has a buffer that does not match its bounds.");
+            }
+            if (file.size() < header->data_offset + header->cell_count * sizeof(T)) {
+                __Util__Impl::throw_bad_grid_file(path, "is truncated.");
+            }
+        }
+
+        const T& operator[](const std::array<int, K>& indices) const {
+            check(indices);
+            return cells[mapping.offset(indices)];
+        }
+
+        T& operator[](const std::array<int, K>& indices) requires writable {
+            check(indices);
+            return cells[mapping.offset(indices)];
+        }
+
+        /* Skips the bounds check. Out of bounds indices are undefined behavior. */
+        const T& get_unchecked(const std::array<int, K>& indices) const {
+            return cells[mapping.offset(indices)];
+        }
+
+        T& get_unchecked(const std::array<int, K>& indices) requires writable {
+            return cells[mapping.offset(indices)];
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        std::size_t size() const {
+            std::size_t count {1};
+            for (int k {0}; k < K; k++) {
+                count *= static_cast<std::size_t>(static_cast<std::ptrdiff_t>(bounds[2 * k+1]) - bounds[2 * k] + 1);
+            }
+            return count;
+        }
+
+        MapMode get_mode() const {
+            return Mode;
+        }
+
+        /* The mapped cells as a view, for slicing, striding, and so on, with no copy. */
+        KDGridView<const T, K> view() const requires Layout::is_row_major {
+            return {&get_unchecked(lower_corner()), bounds, mapping.get_strides()};
+        }
+
+        KDGridView<T, K> view() requires Layout::is_row_major && writable {
+            return {&get_unchecked(lower_corner()), bounds, mapping.get_strides()};
+        }
+
+        /* An ordinary grid holding a copy of every cell. */
+        KDGrid<T, K, Layout> to_grid() const requires std::default_initializable<T> {
+            KDGrid<T, K, Layout> grid {bounds};
+            std::memcpy(static_cast<void*>(grid.buffer().data()), static_cast<const void*>(cells), grid.buffer().size_bytes());
+            return grid;
+        }
+
+    private:
+        static std::array<int, K*2> read_bounds(const MappedFile& file, const std::string& path) {
+            using namespace __Util__Impl;
+
+            GridFileHeader header;
+            if (file.size() < sizeof(header)) {
+                throw_bad_grid_file(path, "is too short to be a saved grid.");
+            }
+            std::memcpy(&header, file.data(), sizeof(header));
+
+            if (header.magic != grid_file_magic) {
+                throw_bad_grid_file(path, "is not a saved grid.");
+            }
+            if (header.byte_order != grid_file_byte_order) {
+                throw_bad_grid_file(path, "was saved on a machine with a different byte order.");
+            }
+            if (header.element_size != sizeof(T) || header.element_align != alignof(T)) {
+                throw_bad_grid_file(path, "holds cells of a different type.");
+            }
+            if (header.dimensions != K) {
+                throw_bad_grid_file(path, "has " + std::to_string(header.dimensions) + " dimensions, not " + std::to_string(K) + ".");
+            }
+            if (header.layout != Layout::id) {
+                throw_bad_grid_file(path, "was saved with a different layout.");
+            }
+            if (header.data_offset != grid_file_data_offset<K>() || file.size() < header.data_offset) {
+                throw_bad_grid_file(path, "has a corrupt header.");
+            }
+
+            std::array<std::int32_t, K*2> saved;
+            std::memcpy(saved.data(), file.data() + sizeof(header), sizeof(saved));
+            std::array<int, K*2> bounds;
+            std::copy(saved.begin(), saved.end(), bounds.begin());
+            return bounds;
+        }
+
+        void check(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+        }
+
+        [[noreturn, gnu::cold, gnu::noinline]] void throw_out_of_range(int k, int index) const {
+            throw std::out_of_range("MappedKDGrid: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+
+        std::array<int, K> lower_corner() const {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = bounds[2 * k];
+            }
+            return corner;
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_MAPPED_KD_GRID_H */
@@ -0,0 +1,349 @@
+/*
+ * kd_grid/parallel.h
+ *
+ * Data parallel operations over a whole KDGrid: map, reduce, zip_with, for_each
+ * and stencil. The grid is cut into slabs along its first dimension, one per
+ * thread, and each thread walks its slab a contiguous row at a time, so the inner
+ * loops are plain loops over memory that the compiler is free to vectorize.
+ *
+ * Every function takes a thread count; 0 means std::thread::hardware_concurrency.
+ * Small grids are done on the calling thread.
+ *
+ * Bit packed KDGrid<bool, K> inputs work too: their rows are unpacked a word at
+ * a time into a buffer of bools before the row loop sees them.
+ */
+#ifndef jackcasey067_KD_GRID_PARALLEL_H
+#define jackcasey067_KD_GRID_PARALLEL_H
+
+#include "kd_grid.h"
+#include "threads.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        /* Below this many cells, starting threads costs more than it saves. */
+        constexpr std::size_t parallel_threshold {1 << 15};
+
+        template<typename T, int K>
+        std::array<int, K> lower_corner(const KDGrid<T, K>& grid) {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = grid.get_bounds()[2 * k];
+            }
+            return corner;
+        }
+
+        template<typename T, int K>
+        std::array<int, K> upper_corner(const KDGrid<T, K>& grid) {
+            std::array<int, K> corner;
+            for (int k {0}; k < K; k++) {
+                corner[k] = grid.get_bounds()[2 * k+1];
+            }
+            return corner;
+        }
+
+        /* Reads bit i of the row starting at column offset of a bit packed row. */
+        inline bool row_bit(std::span<const std::uint64_t> words, std::size_t offset, std::size_t i) {
+            const std::size_t column {offset + i};
+            return (words[column / 64] >> (column % 64)) & 1;
+        }
+
+        /* Stands in for a region of a bit packed grid in for_each_slab, with a
+         * for_each_row that hands out each row unpacked into bools. */
+        template<int K>
+        class UnpackedSlab {
+        private:
+            const KDGrid<bool, K>& grid;
+            std::array<int, K> min;
+            std::array<int, K> max;
+
+        public:
+            UnpackedSlab(const KDGrid<bool, K>& grid, const std::array<int, K>& min, const std::array<int, K>& max)
+                : grid {grid}, min {min}, max {max} {}
+
+            /* Calls func(first, row) for every row, as KDGridView::for_each_row does. */
+            template<typename Func>
+            void for_each_row(Func func) const {
+                const std::size_t length {static_cast<std::size_t>(max[K - 1] - min[K - 1] + 1)};
+                const std::size_t offset {static_cast<std::size_t>(min[K - 1] - grid.get_bounds()[2 * K - 2])};
+                std::unique_ptr<bool[]> cells {new bool[length]};
+
+                std::array<int, K> first {min};
+                while (true) {
+                    std::span<const std::uint64_t> words {grid.row_words(first)};
+                    for (std::size_t i {0}; i < length; i++) {
+                        cells[i] = row_bit(words, offset, i);
+                    }
+                    func(std::as_const(first), std::span<const bool>(cells.get(), length));
+
+                    int k {K - 2};
+                    while (k >= 0 && first[k] == max[k]) {
+                        first[k] = min[k];
+                        k--;
+                    }
+                    if (k < 0) {
+                        return;
+                    }
+                    first[k]++;
+                }
+            }
+        };
+
+        /* Calls func(piece_index, region) with one slab of the grid per thread. */
+        template<typename Grid, typename Func>
+        void for_each_slab(Grid& grid, unsigned threads, Func func) {
+            std::array min {lower_corner(grid)};
+            std::array max {upper_corner(grid)};
+            if (grid.size() < parallel_threshold) {
+                threads = 1;
+            }
+
+            parallel_for(min[0], max[0], thread_count(threads), [&](unsigned piece, int first, int last) {
+                std::array slab_min {min};
+                std::array slab_max {max};
+                slab_min[0] = first;
+                slab_max[0] = last;
+                if constexpr (std::is_same_v<std::remove_const_t<Grid>, KDGrid<bool, Grid::dimensions>>) {
+                    func(piece, UnpackedSlab<Grid::dimensions> {grid, slab_min, slab_max});
+                }
+                else {
+                    func(piece, grid.region(slab_min, slab_max));
+                }
+            });
+        }
+
+        /* A function giving the i'th cell of the row of grid starting at first. */
+        template<typename S, int K>
+        auto row_reader(const KDGrid<S, K>& grid, const std::type_identity_t<std::array<int, K>>& first) {
+            if constexpr (std::is_same_v<S, bool>) {
+                std::span<const std::uint64_t> words {grid.row_words(first)};
+                const std::size_t offset {static_cast<std::size_t>(first[K - 1] - grid.get_bounds()[2 * K - 2])};
+                return [words, offset](std::size_t i) {
+                    return row_bit(words, offset, i);
+                };
+            }
+            else {
+                const S* cells {&grid.get_unchecked(first)};
+                return [cells](std::size_t i) -> const S& {
+                    return cells[i];
+                };
+            }
+        }
+
+        /* Writes value_at(i) to the i'th cell of the row starting at first. Bit packed
+         * results have no contiguous cells to hand out. */
+        template<typename U, int K, typename Func>
+        void write_row(KDGrid<U, K>& result, std::type_identity_t<std::array<int, K>> first, std::size_t length, Func value_at) {
+            if constexpr (std::is_same_v<U, bool>) {
+                for (std::size_t i {0}; i < length; i++) {
+                    result.get_unchecked(first) = value_at(i);
+                    first[K - 1]++;
+                }
+            }
+            else {
+                U* out {&result.get_unchecked(first)};
+                for (std::size_t i {0}; i < length; i++) {
+                    out[i] = value_at(i);
+                }
+            }
+        }
+
+        template<typename T, int K, typename U>
+        void check_same_bounds(const KDGrid<T, K>& a, const KDGrid<U, K>& b) {
+            if (a.get_bounds() != b.get_bounds()) {
+                throw std::invalid_argument("KDGrid: Parallel operations need grids with the same bounds.");
+            }
+        }
+    }
+
+    namespace Grid {
+        /* The cells within some radius of a stencil's center. Cells of a bool grid
+         * are read by value, since they are bits. */
+        template<typename T, int K>
+        class Neighbourhood {
+        private:
+            const KDGrid<T, K>& grid;
+            std::array<int, K> center;
+            int radius;
+            bool interior; // All neighbours within radius are in bounds, so skip checks.
+            const T& outside;
+
+        public:
+            Neighbourhood(const KDGrid<T, K>& grid, const std::array<int, K>& center, int radius, bool interior, const T& outside)
+                : grid {grid}, center {center}, radius {radius}, interior {interior}, outside {outside} {}
+
+            /* The cell at center + offset, or the stencil's outside value if that is
+             * past the edge of the grid. Offsets past the stencil's radius work, but
+             * are always bounds checked. */
+            std::conditional_t<std::is_same_v<T, bool>, bool, const T&> operator[](const std::array<int, K>& offset) const {
+                std::array<int, K> indices;
+                bool within_radius {true};
+                for (int k {0}; k < K; k++) {
+                    indices[k] = center[k] + offset[k];
+                    within_radius = within_radius && offset[k] >= -radius && offset[k] <= radius;
+                }
+                if (!(interior && within_radius) && !grid.in_bounds(indices)) {
+                    return outside;
+                }
+                return grid.get_unchecked(indices);
+            }
+
+            const std::array<int, K>& get_center() const {
+                return center;
+            }
+        };
+
+        /* Calls func(indices, cell) on every cell. Which thread visits which cell is
+         * unspecified, so func must be safe to call concurrently. For bool grids,
+         * cell is a KDGrid<bool, K>::reference, so take it as auto&. */
+        template<typename T, int K, typename Func>
+        void for_each(KDGrid<T, K>& grid, Func func, unsigned threads = 0) {
+            if constexpr (std::is_same_v<T, bool>) {
+                __Util__Impl::for_each_slab(std::as_const(grid), __Util__Impl::output_threads<T, K>(threads), [&](unsigned, auto region) {
+                    region.for_each_row([&](const std::array<int, K>& first, std::span<const bool> row) {
+                        std::array<int, K> indices {first};
+                        for (std::size_t i {0}; i < row.size(); i++) {
+                            typename KDGrid<bool, K>::reference cell {grid.get_unchecked(indices)};
+                            func(std::as_const(indices), cell);
+                            indices[K - 1]++;
+                        }
+                    });
+                });
+            }
+            else {
+                __Util__Impl::for_each_slab(grid, threads, [&func](unsigned, auto region) {
+                    region.for_each(std::ref(func));
+                });
+            }
+        }
+
+        /* A new grid holding func(cell) for every cell of grid. */
+        template<typename T, int K, typename Func, typename U = std::invoke_result_t<Func&, const T&>>
+            requires std::default_initializable<U>
+        KDGrid<U, K> map(const KDGrid<T, K>& grid, Func func, unsigned threads = 0) {
+            KDGrid<U, K> result {grid.get_bounds()};
+            __Util__Impl::for_each_slab(grid, __Util__Impl::output_threads<U, K>(threads), [&](unsigned, auto region) {
+                region.for_each_row([&](const std::array<int, K>& first, std::span<const T> row) {
+                    __Util__Impl::write_row(result, first, row.size(), [&](std::size_t i) {
+                        return func(row[i]);
+                    });
+                });
+            });
+            return result;
+        }
+
+        /* Replaces every cell with func(cell). */
+        template<typename T, int K, typename Func>
+        void map_in_place(KDGrid<T, K>& grid, Func func, unsigned threads = 0) {
+            if constexpr (std::is_same_v<T, bool>) {
+                // Each row is unpacked before it is written back, so reads see old values.
+                __Util__Impl::for_each_slab(std::as_const(grid), __Util__Impl::output_threads<T, K>(threads), [&](unsigned, auto region) {
+                    region.for_each_row([&](const std::array<int, K>& first, std::span<const bool> row) {
+                        __Util__Impl::write_row(grid, first, row.size(), [&](std::size_t i) {
+                            return func(row[i]);
+                        });
+                    });
+                });
+            }
+            else {
+                __Util__Impl::for_each_slab(grid, threads, [&func](unsigned, auto region) {
+                    region.for_each_row([&func](const std::array<int, K>&, std::span<T> row) {
+                        for (T& cell : row) {
+                            cell = func(std::as_const(cell));
+                        }
+                    });
+                });
+            }
+        }
+
+        /* A new grid holding func(a_cell, b_cell) for every pair of cells with the
+         * same indices. The grids must have the same bounds. */
+        template<typename T, typename S, int K, typename Func, typename U = std::invoke_result_t<Func&, const T&, const S&>>
+            requires std::default_initializable<U>
+        KDGrid<U, K> zip_with(const KDGrid<T, K>& a, const KDGrid<S, K>& b, Func func, unsigned threads = 0) {
+            __Util__Impl::check_same_bounds(a, b);
+
+            KDGrid<U, K> result {a.get_bounds()};
+            __Util__Impl::for_each_slab(a, __Util__Impl::output_threads<U, K>(threads), [&](unsigned, auto region) {
+                region.for_each_row([&](const std::array<int, K>& first, std::span<const T> row) {
+                    auto other {__Util__Impl::row_reader(b, first)};
+                    __Util__Impl::write_row(result, first, row.size(), [&](std::size_t i) {
+                        return func(row[i], other(i));
+                    });
+                });
+            });
+            return result;
+        }
+
+        /* Folds every cell into identity with op. Each thread folds its own slab from
+         * identity, and the results are then folded in order, so op must be
+         * associative and identity must be its identity. */
+        template<typename T, int K, typename U, typename Op>
+        U reduce(const KDGrid<T, K>& grid, U identity, Op op, unsigned threads = 0) {
+            std::vector<U> partials (__Util__Impl::thread_count(threads), identity);
+            __Util__Impl::for_each_slab(grid, threads, [&](unsigned piece, auto region) {
+                U accumulator {identity};
+                region.for_each_row([&](const std::array<int, K>&, std::span<const T> row) {
+                    for (const T& cell : row) {
+                        accumulator = op(accumulator, cell);
+                    }
+                });
+                partials[piece] = accumulator;
+            });
+
+            U result {identity};
+            for (const U& partial : partials) {
+                result = op(result, partial);
+            }
+            return result;
+        }
+
+        /* A new grid where each cell is func(neighbourhood), and the neighbourhood
+         * reaches radius cells in every dimension. Neighbours past the edge of the
+         * grid read as outside. Only edge cells, and reads past the radius, pay for
+         * bounds checks. Throws std::invalid_argument if radius is negative. */
+        template<typename T, int K, typename Func, typename U = std::invoke_result_t<Func&, const Neighbourhood<T, K>&>>
+            requires std::default_initializable<U>
+        KDGrid<U, K> stencil(const KDGrid<T, K>& grid, int radius, Func func, const T& outside, unsigned threads = 0) {
+            if (radius < 0) {
+                throw std::invalid_argument("KDGrid: Stencil radius " + std::to_string(radius) + " is negative.");
+            }
+            const std::array<int, K*2>& bounds {grid.get_bounds()};
+
+            KDGrid<U, K> result {bounds};
+            __Util__Impl::for_each_slab(grid, __Util__Impl::output_threads<U, K>(threads), [&](unsigned, auto region) {
+                region.for_each_row([&](const std::array<int, K>& first, std::span<const T> row) {
+                    bool interior_row {true};
+                    for (int k {0}; k < K - 1; k++) {
+                        interior_row = interior_row && static_cast<long long>(first[k]) - radius >= bounds[2 * k] && static_cast<long long>(first[k]) + radius <= bounds[2 * k+1];
+                    }
+
+                    __Util__Impl::write_row(result, first, row.size(), [&](std::size_t i) {
+                        std::array<int, K> center {first};
+                        center[K - 1] += static_cast<int>(i);
+                        bool interior {interior_row && static_cast<long long>(center[K - 1]) - radius >= bounds[2 * K - 2] && static_cast<long long>(center[K - 1]) + radius <= bounds[2 * K - 1]};
+
+                        const Neighbourhood<T, K> neighbourhood {grid, center, radius, interior, outside};
+                        return func(neighbourhood);
+                    });
+                });
+            });
+            return result;
+        }
+    }
+}
+
+#endif /* jackcasey067_KD_GRID_PARALLEL_H */
@@ -0,0 +1,303 @@
+/*
+ * kd_grid/prefix_sum.h
+ *
+ * K dimension prefix sums over a numeric KDGrid, answering the sum over any box
+ * without visiting the cells in it.
+ *
+ * SummedAreaTable is static: queries are O(2^K), and rebuilding after changes is a
+ * few passes over contiguous rows. FenwickTree supports point updates instead:
+ * updates and queries are both O(2^K log^K n).
+ */
+#ifndef jackcasey067_KD_GRID_PREFIX_SUM_H
+#define jackcasey067_KD_GRID_PREFIX_SUM_H
+
+#include "kd_grid.h"
+
+#include <array>
+#include <bit>
+#include <climits>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+namespace Util {
+    namespace __Util__Impl {
+        /* Sums f(corner) * sign over the 2^K corners of the box that inclusion-exclusion
+         * needs, where corner k is either max[k] or min[k] - 1. A corner below INT_MIN
+         * is below any grid, so its prefix is zero and it is skipped. */
+        template<typename Sum, int K, typename Func>
+        Sum inclusion_exclusion(const std::array<int, K>& min, const std::array<int, K>& max, Func prefix) {
+            Sum total {};
+            for (unsigned mask {0}; mask < (1u << K); mask++) {
+                std::array<int, K> corner;
+                bool below_int_min {false};
+                for (int k {0}; k < K; k++) {
+                    below_int_min = below_int_min || ((mask >> k) & 1 && min[k] == INT_MIN);
+                    corner[k] = (mask >> k) & 1 && min[k] != INT_MIN ? min[k] - 1 : max[k];
+                }
+                if (below_int_min) {
+                    continue;
+                }
+
+                if (std::popcount(mask) % 2 == 0) {
+                    total += prefix(corner);
+                }
+                else {
+                    total -= prefix(corner);
+                }
+            }
+            return total;
+        }
+
+        template<int K>
+        void check_box(const std::array<int, K*2>& bounds, const std::array<int, K>& min, const std::array<int, K>& max) {
+            for (int k {0}; k < K; k++) {
+                if (min[k] > max[k]) {
+                    throw std::invalid_argument("Prefix sum: Box is empty in the " + std::to_string(k + 1) + "'th dimension.");
+                }
+                if (min[k] < bounds[2 * k] || max[k] > bounds[2 * k+1]) {
+                    throw std::out_of_range("Prefix sum: Box leaves the grid in the " + std::to_string(k + 1) + "'th dimension.");
+                }
+            }
+        }
+
+        /* Bounds with one extra (all zero) layer below the min of each dimension,
+         * which spares the queries from checking for min - 1. */
+        template<int K>
+        std::array<int, K*2> padded_below(std::array<int, K*2> bounds) {
+            for (int k {0}; k < K; k++) {
+                if (bounds[2 * k] == INT_MIN) {
+                    throw std::invalid_argument("SummedAreaTable: In the " + std::to_string(k + 1)
+                        + "'th dimension, min is INT_MIN, leaving no room for the layer of zeros below it.");
+                }
+                bounds[2 * k]--;
+            }
+            return bounds;
+        }
+    }
+
+    /* Sum is the type that sums are accumulated in, for when T would overflow. The
+     * grid's mins must be above INT_MIN, or the constructor throws
+     * std::invalid_argument. */
+    template<typename T, int K, typename Sum = T>
+    class SummedAreaTable {
+    private:
+        std::array<int, K*2> bounds; // Of the source grid.
+
+        /* table[i] is the sum of every source cell at or below i in every dimension. */
+        KDGrid<Sum, K> table;
+
+    public:
+        SummedAreaTable(const KDGrid<T, K>& grid)
+            : bounds {grid.get_bounds()}, table {__Util__Impl::padded_below<K>(bounds), Sum {}}
+        {
+            rebuild(grid);
+        }
+
+        /* Recomputes every sum from grid, which must have the same bounds as the
+         * original, reusing the existing table. */
+        void rebuild(const KDGrid<T, K>& grid) {
+            if (grid.get_bounds() != bounds) {
+                throw std::invalid_argument("SummedAreaTable: Cannot rebuild from a grid with different bounds.");
+            }
+
+            std::array<int, K> min;
+            std::array<int, K> max;
+            for (int k {0}; k < K; k++) {
+                min[k] = bounds[2 * k];
+                max[k] = bounds[2 * k+1];
+            }
+            auto cells {table.region(min, max)};
+
+            // Running sums along each row (the contiguous dimension)...
+            grid.region().for_each_row([&cells](const std::array<int, K>& first, std::span<const T> row) {
+                Sum* out {&cells[first]};
+                Sum running {};
+                for (std::size_t i {0}; i < row.size(); i++) {
+                    running += row[i];
+                    out[i] = running;
+                }
+            });
+
+            // ... then along the other dimensions, one whole row at a time.
+            for (int d {K - 2}; d >= 0; d--) {
+                cells.for_each_row([&cells, d, &min](const std::array<int, K>& first, std::span<Sum> row) {
+                    if (first[d] == min[d]) {
+                        return;
+                    }
+                    std::array<int, K> previous {first};
+                    previous[d]--;
+                    const Sum* below {&cells[previous]};
+                    for (std::size_t i {0}; i < row.size(); i++) {
+                        row[i] += below[i];
+                    }
+                });
+            }
+        }
+
+        /* The sum of the cells in the inclusive box from min to max. O(2^K). */
+        Sum sum(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            __Util__Impl::check_box<K>(bounds, min, max);
+            return __Util__Impl::inclusion_exclusion<Sum, K>(min, max, [this](const std::array<int, K>& corner) {
+                return table.get_unchecked(corner);
+            });
+        }
+
+        /* The sum of every cell at or below indices in every dimension. */
+        Sum prefix(const std::array<int, K>& indices) const {
+            return table[indices];
+        }
+
+        Sum total() const {
+            std::array<int, K> max;
+            for (int k {0}; k < K; k++) {
+                max[k] = bounds[2 * k+1];
+            }
+            return table.get_unchecked(max);
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+    };
+
+    /* A K dimension Fenwick (binary indexed) tree. Like a KDGrid of T that starts
+     * at zero, but with box sums. */
+    template<typename T, int K>
+    class FenwickTree {
+    private:
+        std::array<int, K*2> bounds;
+
+        /* Indexed from 1 in every dimension, as Fenwick trees like to be. Index 0 is
+         * unused padding. */
+        KDGrid<T, K> tree;
+
+    public:
+        /* Every cell starts at zero. */
+        FenwickTree(std::array<int, K*2> bounds) : bounds {bounds}, tree {tree_bounds(bounds), T {}} {}
+
+        /* Starts with the cells of grid, in O(cells). */
+        FenwickTree(const KDGrid<T, K>& grid) : FenwickTree(grid.get_bounds()) {
+            grid.region().for_each([this](const std::array<int, K>& indices, const T& cell) {
+                tree.get_unchecked(to_tree(indices)) = cell;
+            });
+
+            // Push each node into its parent, one dimension at a time.
+            std::array<int, K> sizes;
+            for (int k {0}; k < K; k++) {
+                sizes[k] = bounds[2 * k+1] - bounds[2 * k] + 1;
+            }
+            for (int d {0}; d < K; d++) {
+                tree.region().for_each([this, d, &sizes](const std::array<int, K>& node, T& value) {
+                    if (node[d] == 0) {
+                        return;
+                    }
+                    std::array<int, K> parent {node};
+                    parent[d] += node[d] & -node[d];
+                    if (parent[d] <= sizes[d]) {
+                        tree.get_unchecked(parent) += value;
+                    }
+                });
+            }
+        }
+
+        /* Adds delta to the cell at indices. O(log^K n). */
+        void add(const std::array<int, K>& indices, const T& delta) {
+            check(indices);
+            std::array<int, K> node {to_tree(indices)};
+            add_impl<0>(node, delta);
+        }
+
+        /* The sum of every cell at or below indices in every dimension. O(log^K n). */
+        T prefix(const std::array<int, K>& indices) const {
+            check(indices);
+            std::array<int, K> node {to_tree(indices)};
+            return prefix_impl<0>(node);
+        }
+
+        /* The sum of the cells in the inclusive box from min to max. */
+        T sum(const std::array<int, K>& min, const std::array<int, K>& max) const {
+            __Util__Impl::check_box<K>(bounds, min, max);
+            return __Util__Impl::inclusion_exclusion<T, K>(min, max, [this](const std::array<int, K>& corner) {
+                std::array<int, K> node {to_tree(corner)};
+                return prefix_impl<0>(node);
+            });
+        }
+
+        /* The value of one cell. */
+        T get(const std::array<int, K>& indices) const {
+            return sum(indices, indices);
+        }
+
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+    private:
+        static std::array<int, K*2> tree_bounds(const std::array<int, K*2>& bounds) {
+            std::array<int, K*2> result;
+            for (int k {0}; k < K; k++) {
+                if (bounds[2 * k+1] < bounds[2 * k]) {
+                    throw std::invalid_argument("FenwickTree: In the " + std::to_string(k + 1) + "'th dimension, max is less than min.");
+                }
+                result[2 * k] = 0;
+                result[2 * k+1] = bounds[2 * k+1] - bounds[2 * k] + 1;
+            }
+            return result;
+        }
+
+        std::array<int, K> to_tree(const std::array<int, K>& indices) const {
+            std::array<int, K> node;
+            for (int k {0}; k < K; k++) {
+                node[k] = indices[k] - bounds[2 * k] + 1;
+            }
+            return node;
+        }
+
+        void check(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw std::out_of_range("FenwickTree: Index " + std::to_string(indices[k]) + " is out of bounds in the "
+                        + std::to_string(k + 1) + "'th dimension.");
+                }
+            }
+        }
+
+        /* One nested loop per dimension. node is scratch space. */
+        template<int D>
+        void add_impl(std::array<int, K>& node, const T& delta) {
+            const int start {node[D]};
+            const int size {bounds[2 * D+1] - bounds[2 * D] + 1};
+            for (int i {start}; i <= size; i += i & -i) {
+                node[D] = i;
+                if constexpr (D == K - 1) {
+                    tree.get_unchecked(node) += delta;
+                }
+                else {
+                    add_impl<D + 1>(node, delta);
+                }
+            }
+            node[D] = start;
+        }
+
+        /* Corners just below the grid (index 0) contribute nothing. */
+        template<int D>
+        T prefix_impl(std::array<int, K>& node) const {
+            const int start {node[D]};
+            T total {};
+            for (int i {start}; i > 0; i -= i & -i) {
+                node[D] = i;
+                if constexpr (D == K - 1) {
+                    total += tree.get_unchecked(node);
+                }
+                else {
+                    total += prefix_impl<D + 1>(node);
+                }
+            }
+            node[D] = start;
+            return total;
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_PREFIX_SUM_H */
@@ -0,0 +1,152 @@
+/*
+ * kd_grid/search.h
+ *
+ * Breadth first search and flood fill over a KDGrid. Both start from any number
+ * of sources and expand one frontier at a time. Large frontiers are expanded by
+ * several threads at once, which race to claim cells in a bit packed visited set.
+ */
+#ifndef jackcasey067_KD_GRID_SEARCH_H
+#define jackcasey067_KD_GRID_SEARCH_H
+
+#include "kd_grid.h"
+#include "parallel.h"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace Util {
+    namespace Grid {
+        enum class Connectivity {
+            Faces, // The 2K neighbours that differ in one dimension by one.
+            All,   // All 3^K - 1 neighbours, diagonals included.
+        };
+
+        /* Distance of cells that the search never reached. */
+        constexpr int unreachable {-1};
+    }
+
+    namespace __Util__Impl {
+        /* Below this many cells, a frontier is expanded on the calling thread. */
+        constexpr std::size_t parallel_frontier {1 << 12};
+
+        template<int K>
+        std::vector<std::array<int, K>> neighbour_offsets(Grid::Connectivity connectivity) {
+            std::vector<std::array<int, K>> offsets;
+            if (connectivity == Grid::Connectivity::Faces) {
+                for (int k {0}; k < K; k++) {
+                    for (int step : {-1, 1}) {
+                        std::array<int, K> offset {};
+                        offset[k] = step;
+                        offsets.push_back(offset);
+                    }
+                }
+                return offsets;
+            }
+
+            std::array<int, K> offset;
+            offset.fill(-1);
+            while (true) {
+                if (offset != std::array<int, K> {}) {
+                    offsets.push_back(offset);
+                }
+
+                int k {K - 1};
+                while (k >= 0 && offset[k] == 1) {
+                    offset[k] = -1;
+                    k--;
+                }
+                if (k < 0) {
+                    return offsets;
+                }
+                offset[k]++;
+            }
+        }
+
+        /* The frontier engine under bfs and flood_fill. Calls on_visit(indices, level)
+         * exactly once for each reached cell, possibly from several threads at once
+         * (but never twice for one cell). passable is also called from several
+         * threads at once, and may be asked about a cell more than once. Returns the
+         * visited set. */
+        template<typename Grid, int K, typename Passable, typename OnVisit>
+        KDGrid<bool, K> frontier_search(const Grid& grid, const std::vector<std::array<int, K>>& sources, Passable& passable,
+                Util::Grid::Connectivity connectivity, unsigned threads, OnVisit on_visit) {
+            const std::vector<std::array<int, K>> offsets {neighbour_offsets<K>(connectivity)};
+            KDGrid<bool, K> visited {grid.get_bounds()};
+
+            std::vector<std::array<int, K>> frontier;
+            for (const std::array<int, K>& source : sources) {
+                if (!visited[source]) { // Checks bounds.
+                    visited[source] = true;
+                    on_visit(source, 0);
+                    frontier.push_back(source);
+                }
+            }
+
+            threads = thread_count(threads);
+            std::vector<std::vector<std::array<int, K>>> next (threads);
+
+            for (int level {1}; !frontier.empty(); level++) {
+                unsigned pieces {frontier.size() < parallel_frontier ? 1 : threads};
+
+                parallel_for(0, static_cast<int>(frontier.size()) - 1, pieces, [&](unsigned piece, int first, int last) {
+                    std::vector<std::array<int, K>>& found {next[piece]};
+                    for (int i {first}; i <= last; i++) {
+                        for (const std::array<int, K>& offset : offsets) {
+                            std::array<int, K> neighbour;
+                            for (int k {0}; k < K; k++) {
+                                neighbour[k] = frontier[i][k] + offset[k];
+                            }
+
+                            if (grid.in_bounds(neighbour) && passable(grid.get_unchecked(neighbour))
+                                    && !visited.atomic_test_and_set(neighbour)) {
+                                on_visit(neighbour, level);
+                                found.push_back(neighbour);
+                            }
+                        }
+                    }
+                });
+
+                frontier.clear();
+                for (std::vector<std::array<int, K>>& found : next) {
+                    frontier.insert(frontier.end(), found.begin(), found.end());
+                    found.clear();
+                }
+            }
+
+            return visited;
+        }
+    }
+
+    namespace Grid {
+        /* Shortest path lengths (in steps) from the nearest source to every cell, moving
+         * only through cells where passable(cell) is true. Sources count as reached
+         * whether or not they are passable. Unreached cells are unreachable (-1).
+         * passable is called from several threads at once, so must be thread safe;
+         * a predicate with state (a counter, a cache) needs its own locking, or
+         * threads = 1. */
+        template<typename T, int K, typename Layout, typename Passable>
+        KDGrid<int, K> bfs(const KDGrid<T, K, Layout>& grid, const std::type_identity_t<std::vector<std::array<int, K>>>& sources, Passable passable,
+                Connectivity connectivity = Connectivity::Faces, unsigned threads = 0) {
+            KDGrid<int, K> distances {grid.get_bounds(), unreachable};
+            __Util__Impl::frontier_search<KDGrid<T, K, Layout>, K>(grid, sources, passable, connectivity, threads,
+                [&distances](const std::array<int, K>& indices, int level) {
+                    distances.get_unchecked(indices) = level;
+                });
+            return distances;
+        }
+
+        /* Every cell connected to a seed through cells where passable(cell) is true.
+         * Seeds are included whether or not they are passable. As for bfs, passable
+         * is called from several threads at once, so must be thread safe. */
+        template<typename T, int K, typename Layout, typename Passable>
+        KDGrid<bool, K> flood_fill(const KDGrid<T, K, Layout>& grid, const std::type_identity_t<std::vector<std::array<int, K>>>& seeds, Passable passable,
+                Connectivity connectivity = Connectivity::Faces, unsigned threads = 0) {
+            return __Util__Impl::frontier_search<KDGrid<T, K, Layout>, K>(grid, seeds, passable, connectivity, threads,
+                [](const std::array<int, K>&, int) {});
+        }
+    }
+}
+
+#endif /* jackcasey067_KD_GRID_SEARCH_H */
@@ -0,0 +1,214 @@
+/*
+ * kd_grid/sparse_kd_grid.h
+ *
+ * A k dimension grid for huge domains where few cells are ever written. The grid
+ * is split into cubic chunks, and a chunk is only allocated when one of its cells
+ * is first written. Untouched cells read as the default value.
+ */
+#ifndef jackcasey067_KD_GRID_SPARSE_KD_GRID_H
+#define jackcasey067_KD_GRID_SPARSE_KD_GRID_H
+
+#include "kd_grid.h"
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace Util {
+    namespace __Util__Impl {
+        template<int K>
+        struct IndicesHash {
+            std::size_t operator()(const std::array<int, K>& indices) const {
+                std::size_t hash {0};
+                for (int index : indices) {
+                    hash = (hash ^ std::hash<int>()(index)) * 1099511628211ull; // FNV-1a style mixing
+                }
+                return hash;
+            }
+        };
+    }
+
+    /* ChunkSide is the side length of a chunk, in cells, and must be a power of two.
+     * The default suits two to four dimensions; lower it for more. */
+    template<typename T, int K, int ChunkSide = 8>
+    class SparseKDGrid {
+        static_assert(K >= 1, "SparseKDGrid needs at least one dimension.");
+        static_assert(ChunkSide > 0 && (ChunkSide & (ChunkSide - 1)) == 0, "ChunkSide must be a power of two.");
+
+    private:
+        static constexpr std::size_t chunk_cells {[]() {
+            std::size_t count {1};
+            for (int k {0}; k < K; k++) {
+                count *= ChunkSide;
+            }
+            return count;
+        }()};
+
+        using Chunk = __Util__Impl::CellBuffer<T>;
+
+        std::array<int, K*2> bounds; // min1, max1, min2, max2, ...
+        T default_value;
+
+        /* Keyed by chunk coordinates, (indices - min) / ChunkSide. */
+        std::unordered_map<std::array<int, K>, Chunk, __Util__Impl::IndicesHash<K>> chunks {};
+
+    public:
+        static constexpr int dimensions {K};
+
+        /* Takes an array of the inclusive bounds in order. Eg {{-10, 10, -10, 10}}.
+         * Nothing is allocated until a cell is written. */
+        SparseKDGrid(std::array<int, K*2> bounds, T default_value)
+            : bounds {bounds}, default_value {default_value}
+        {
+            for (int k {0}; k < K; k++) {
+                if (bounds[2 * k+1] < bounds[2 * k]) {
+                    throw std::invalid_argument("SparseKDGrid: In the " + std::to_string(k + 1) + "'th dimension, max "
+                        + std::to_string(bounds[2 * k+1]) + " is less than min " + std::to_string(bounds[2 * k]));
+                }
+            }
+        }
+
+        SparseKDGrid(std::array<int, K*2> bounds) requires std::default_initializable<T>
+            : SparseKDGrid(bounds, {}) {}
+
+        /* Write access. Allocates the cell's chunk if this is the first touch, so
+         * prefer get() for reads. */
+        T& operator[](const std::array<int, K>& indices) {
+            check(indices);
+
+            auto [chunk_key, offset] = locate(indices);
+            auto it {chunks.find(chunk_key)};
+            if (it == chunks.end()) {
+                it = chunks.emplace(chunk_key, Chunk(chunk_cells, default_value)).first;
+            }
+            return it->second[offset];
+        }
+
+        /* Read access. Never allocates; cells in untouched chunks are the default. */
+        const T& get(const std::array<int, K>& indices) const {
+            check(indices);
+
+            auto [chunk_key, offset] = locate(indices);
+            auto it {chunks.find(chunk_key)};
+            if (it == chunks.end()) {
+                return default_value;
+            }
+            return it->second[offset];
+        }
+
+        const T& operator[](const std::array<int, K>& indices) const {
+            return get(indices);
+        }
+
+        /* Whether the cell's chunk has been allocated. */
+        bool is_resident(const std::array<int, K>& indices) const {
+            check(indices);
+            return chunks.contains(locate(indices).first);
+        }
+
+        bool in_bounds(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /* The inclusive bounds, in the order given to the constructor. */
+        const std::array<int, K*2>& get_bounds() const {
+            return bounds;
+        }
+
+        const T& get_default() const {
+            return default_value;
+        }
+
+        std::size_t chunk_count() const {
+            return chunks.size();
+        }
+
+        /* Bytes held by the grid: the chunks, and an estimate of the hash table.
+         * Memory owned by the cells themselves (like a std::string's buffer) is not
+         * counted. */
+        std::size_t resident_bytes() const {
+            constexpr std::size_t node_bytes {sizeof(std::array<int, K>) + sizeof(Chunk) + 2 * sizeof(void*)};
+            return sizeof(*this)
+                + chunks.size() * (chunk_cells * sizeof(T) + node_bytes)
+                + chunks.bucket_count() * sizeof(void*);
+        }
+
+        /* Frees every chunk, so every cell is the default again. */
+        void clear() {
+            chunks.clear();
+        }
+
+        /* Calls func(indices, cell) for every in bounds cell in allocated chunks, in no
+         * particular order. Untouched chunks are skipped entirely. */
+        template<typename Func>
+        void for_each_resident(Func func) {
+            for (auto& [chunk_key, chunk] : chunks) {
+                // In long long, since chunks on the upper edges of a grid reaching
+                // INT_MAX poke out past it.
+                std::array<long long, K> first;
+                for (int k {0}; k < K; k++) {
+                    first[k] = static_cast<long long>(bounds[2 * k]) + static_cast<long long>(chunk_key[k]) * ChunkSide;
+                }
+
+                for (std::size_t offset {0}; offset < chunk_cells; offset++) {
+                    std::array<int, K> indices;
+                    std::size_t rest {offset};
+                    bool inside {true};
+                    for (int k {K - 1}; k >= 0; k--) {
+                        long long index {first[k] + static_cast<long long>(rest % ChunkSide)};
+                        rest /= ChunkSide;
+
+                        // Chunks on the upper edges poke out of the grid.
+                        if (index > bounds[2 * k+1]) {
+                            inside = false;
+                            break;
+                        }
+                        indices[k] = static_cast<int>(index);
+                    }
+
+                    if (inside) {
+                        func(std::as_const(indices), chunk[offset]);
+                    }
+                }
+            }
+        }
+
+    private:
+        /* Chunk coordinates, and the offset within the (row major) chunk. */
+        std::pair<std::array<int, K>, std::size_t> locate(const std::array<int, K>& indices) const {
+            std::array<int, K> chunk_key;
+            std::size_t offset {0};
+            for (int k {0}; k < K; k++) {
+                unsigned relative {static_cast<unsigned>(indices[k]) - static_cast<unsigned>(bounds[2 * k])}; // Cannot overflow.
+                chunk_key[k] = static_cast<int>(relative / ChunkSide);
+                offset = offset * ChunkSide + relative % ChunkSide;
+            }
+            return {chunk_key, offset};
+        }
+
+        void check(const std::array<int, K>& indices) const {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+        }
+
+        [[noreturn, gnu::cold, gnu::noinline]] void throw_out_of_range(int k, int index) const {
+            throw std::out_of_range("SparseKDGrid: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_SPARSE_KD_GRID_H */
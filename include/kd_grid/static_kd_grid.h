@@ -0,0 +1,170 @@
+/*
+ * kd_grid/static_kd_grid.h
+ *
+ * A k dimension grid whose bounds are known at compile time. The cells live in a
+ * std::array inside the object (so there is no heap allocation), and all of the
+ * index arithmetic is done with constants. Everything is constexpr.
+ */
+#ifndef jackcasey067_KD_GRID_STATIC_KD_GRID_H
+#define jackcasey067_KD_GRID_STATIC_KD_GRID_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Util {
+    /* Bounds are inclusive and in the same order as KDGrid's, so
+     * StaticKDGrid<int, 0, 63, 0, 63, 0, 63> is a 64x64x64 chunk. Note that large
+     * grids are large objects; think twice before putting one on the stack. */
+    template<std::default_initializable T, int... Bounds>
+    class StaticKDGrid {
+    private:
+        static constexpr int K {sizeof...(Bounds) / 2};
+
+        static_assert(sizeof...(Bounds) % 2 == 0, "StaticKDGrid takes a min and a max for each dimension.");
+        static_assert(K >= 1, "StaticKDGrid needs at least one dimension.");
+
+        static constexpr std::array<int, K*2> bounds {Bounds...};
+
+        static constexpr std::array<std::ptrdiff_t, K> strides {[]() {
+            std::array<std::ptrdiff_t, K> strides {};
+            std::ptrdiff_t stride {1};
+            for (int k {K - 1}; k >= 0; k--) {
+                strides[k] = stride;
+                stride *= static_cast<std::ptrdiff_t>(bounds[2 * k+1]) - bounds[2 * k] + 1;
+            }
+            return strides;
+        }()};
+
+        static constexpr std::ptrdiff_t origin {[]() {
+            std::ptrdiff_t origin {0};
+            for (int k {0}; k < K; k++) {
+                origin += bounds[2 * k] * strides[k];
+            }
+            return origin;
+        }()};
+
+        static constexpr std::size_t cell_count {[]() {
+            std::size_t count {1};
+            for (int k {0}; k < K; k++) {
+                if (bounds[2 * k+1] < bounds[2 * k]) {
+                    throw std::invalid_argument("StaticKDGrid: max is less than min."); // Compile error.
+                }
+                count *= static_cast<std::size_t>(bounds[2 * k+1] - bounds[2 * k] + 1);
+            }
+            return count;
+        }()};
+
+        std::array<T, cell_count> cells {};
+
+    public:
+        static constexpr int dimensions {K};
+
+        constexpr StaticKDGrid() = default;
+
+        constexpr StaticKDGrid(const T& default_value) {
+            cells.fill(default_value);
+        }
+
+        constexpr T& operator[](const std::array<int, K>& indices) {
+            check(indices);
+            return cells[offset(indices)];
+        }
+
+        constexpr const T& operator[](const std::array<int, K>& indices) const {
+            check(indices);
+            return cells[offset(indices)];
+        }
+
+        /* Skips the bounds check. Out of bounds indices are undefined behavior (and
+         * a compile error in a constant expression). */
+        constexpr T& get_unchecked(const std::array<int, K>& indices) {
+            return cells[offset(indices)];
+        }
+
+        constexpr const T& get_unchecked(const std::array<int, K>& indices) const {
+            return cells[offset(indices)];
+        }
+
+        static constexpr bool in_bounds(const std::array<int, K>& indices) {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static constexpr const std::array<int, K*2>& get_bounds() {
+            return bounds;
+        }
+
+        static constexpr std::size_t size() {
+            return cell_count;
+        }
+
+        constexpr void fill(const T& value) {
+            cells.fill(value);
+        }
+
+        /* Calls func(indices, cell) for every cell, in memory order. */
+        template<typename Func>
+        constexpr void for_each(Func func) {
+            for_each_impl(*this, func);
+        }
+
+        template<typename Func>
+        constexpr void for_each(Func func) const {
+            for_each_impl(*this, func);
+        }
+
+        constexpr bool operator==(const StaticKDGrid&) const = default;
+
+    private:
+        static constexpr std::ptrdiff_t offset(const std::array<int, K>& indices) {
+            std::ptrdiff_t offset {-origin};
+            for (int k {0}; k < K; k++) {
+                offset += indices[k] * strides[k];
+            }
+            return offset;
+        }
+
+        static constexpr void check(const std::array<int, K>& indices) {
+            for (int k {0}; k < K; k++) {
+                if (indices[k] < bounds[2 * k] || indices[k] > bounds[2 * k+1]) {
+                    throw_out_of_range(k, indices[k]);
+                }
+            }
+        }
+
+        /* Not constexpr, so reaching it in a constant expression is a compile error. */
+        [[noreturn, gnu::cold, gnu::noinline]] static void throw_out_of_range(int k, int index) {
+            throw std::out_of_range("StaticKDGrid: Length Error. In the " + std::to_string(k + 1) + "'th dimension, tried to reach index "
+                + std::to_string(index) + " but min is " + std::to_string(bounds[2 * k]) + " and max is " + std::to_string(bounds[2 * k+1]));
+        }
+
+        template<typename Self, typename Func>
+        static constexpr void for_each_impl(Self& self, Func& func) {
+            std::array<int, K> indices;
+            for (int k {0}; k < K; k++) {
+                indices[k] = bounds[2 * k];
+            }
+
+            for (std::size_t i {0}; i < cell_count; i++) {
+                func(std::as_const(indices), self.cells[i]);
+
+                int k {K - 1};
+                while (k > 0 && indices[k] == bounds[2 * k+1]) {
+                    indices[k] = bounds[2 * k];
+                    k--;
+                }
+                indices[k]++;
+            }
+        }
+    };
+}
+
+#endif /* jackcasey067_KD_GRID_STATIC_KD_GRID_H */
@@ -0,0 +1,174 @@
+/*
+ * kd_grid/threads.h
+ *
+ * Splitting work across threads, shared by the kd_grid headers. Internal.
+ *
+ * Work runs on one pool of threads, started on first use and kept for the life
+ * of the program, so code that runs many short parallel loops (a search running
+ * one per level, a simulation one per step) does not start threads each time.
+ */
+#ifndef jackcasey067_KD_GRID_THREADS_H
+#define jackcasey067_KD_GRID_THREADS_H
+
+#include <base_classes/noncopyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Util {
+    namespace __Util__Impl {
+        inline unsigned thread_count(unsigned requested) {
+            if (requested != 0) {
+                return requested;
+            }
+            return std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        /* Threads may share a word of a one dimensional bit packed result. Rows of
+         * higher dimensional ones start on their own words. */
+        template<typename U, int K>
+        unsigned output_threads(unsigned threads) {
+            return std::is_same_v<U, bool> && K == 1 ? 1 : threads;
+        }
+
+        /* Worker threads taking tasks from a shared queue. Grows when asked for more
+         * workers than it has, and never shrinks; the destructor finishes the queued
+         * tasks and joins every worker. */
+        class ThreadPool : public NonCopyable {
+        private:
+            std::mutex lock;
+            std::condition_variable wake;
+            std::deque<std::function<void()>> tasks;
+            std::vector<std::thread> workers;
+            bool stopping {false};
+
+        public:
+            ThreadPool() = default;
+
+            ~ThreadPool() {
+                {
+                    std::lock_guard<std::mutex> held {lock};
+                    stopping = true;
+                }
+                wake.notify_all();
+                for (std::thread& worker : workers) {
+                    worker.join();
+                }
+            }
+
+            /* Starts workers until there are at least count. */
+            void reserve(std::size_t count) {
+                std::lock_guard<std::mutex> held {lock};
+                while (workers.size() < count) {
+                    workers.emplace_back([this]() { work(); });
+                }
+            }
+
+            void submit(std::function<void()> task) {
+                {
+                    std::lock_guard<std::mutex> held {lock};
+                    tasks.push_back(std::move(task));
+                }
+                wake.notify_one();
+            }
+
+        private:
+            void work() {
+                while (true) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> held {lock};
+                        wake.wait(held, [this]() { return stopping || !tasks.empty(); });
+                        if (tasks.empty()) {
+                            return;
+                        }
+                        task = std::move(tasks.front());
+                        tasks.pop_front();
+                    }
+                    task();
+                }
+            }
+        };
+
+        /* The pool every parallel_for shares. */
+        inline ThreadPool& shared_pool() {
+            static ThreadPool pool {};
+            return pool;
+        }
+
+        /* Splits [begin, end] (inclusive) into at most threads contiguous pieces and
+         * calls func(piece_index, first, last) for each, in parallel. Blocks until all
+         * are done, and rethrows the first exception thrown by func.
+         *
+         * The calling thread runs pieces too, claiming them alongside the pool's
+         * workers, and only waits for pieces a worker has already started. So a
+         * parallel_for never waits on a busy pool, and may be nested. */
+        template<typename Func>
+        void parallel_for(int begin, int end, unsigned threads, Func func) {
+            const long long length {static_cast<long long>(end) - begin + 1};
+            const long long pieces {std::min<long long>(threads, length)};
+            if (pieces <= 1) {
+                func(0u, begin, end);
+                return;
+            }
+
+            // Shared with the helper tasks, which may start after this returns, when
+            // every piece is claimed and they have nothing left to do.
+            struct Job {
+                std::atomic<long long> next {0};
+                std::atomic<long long> done {0};
+                std::vector<std::exception_ptr> errors;
+                std::function<void(long long)> run;
+            };
+            auto job {std::make_shared<Job>()};
+            job->errors.resize(pieces);
+            job->run = [&func, &errors = job->errors, begin, length, pieces](long long piece) {
+                int first {static_cast<int>(begin + length * piece / pieces)};
+                int last {static_cast<int>(begin + length * (piece + 1) / pieces - 1)};
+                try {
+                    func(static_cast<unsigned>(piece), first, last);
+                }
+                catch (...) {
+                    errors[piece] = std::current_exception();
+                }
+            };
+
+            auto claim_pieces = [](Job& job, long long pieces) {
+                for (long long piece {job.next++}; piece < pieces; piece = job.next++) {
+                    job.run(piece);
+                    if (job.done.fetch_add(1, std::memory_order_acq_rel) + 1 == pieces) {
+                        job.done.notify_all();
+                    }
+                }
+            };
+
+            ThreadPool& pool {shared_pool()};
+            pool.reserve(pieces - 1);
+            for (long long helper {1}; helper < pieces; helper++) {
+                pool.submit([job, pieces, claim_pieces]() { claim_pieces(*job, pieces); });
+            }
+            claim_pieces(*job, pieces);
+
+            for (long long done {job->done.load(std::memory_order_acquire)}; done != pieces; done = job->done.load(std::memory_order_acquire)) {
+                job->done.wait(done, std::memory_order_acquire);
+            }
+
+            for (std::exception_ptr& error : job->errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+    }
+}
+
+#endif /* jackcasey067_KD_GRID_THREADS_H */
@@ -0,0 +1,168 @@
+/*
+ * min_heap/bucket_queue.h
+ *
+ * Dial's bucket queue: a priority queue for integer priorities that all lie within
+ * a small, fixed spread above the last popped minimum, such as Dijkstra's
+ * algorithm with small integer edge weights. There is one bucket per possible
+ * priority in a circular array, so insert and update_priority are O(1), and
+ * pop_min walks forward from the last minimum to the next nonempty bucket.
+ */
+#ifndef jackcasey067_MIN_HEAP_BUCKET_QUEUE_H
+#define jackcasey067_MIN_HEAP_BUCKET_QUEUE_H
+
+#include "bucket_set.h"
+#include "min_heap.h"
+
+#include "concepts.h"
+
+#include <concepts>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+namespace Util {
+    /* Has the interface of MinHeap. Every priority in the queue must be between
+     * the last popped minimum and that plus the spread given at construction
+     * (for Dijkstra, the largest edge weight); insert and update_priority throw
+     * otherwise. An empty queue moves its window just far enough to take whatever
+     * is inserted next. */
+    template<Hashable Value, std::integral Priority = int>
+        requires std::equality_comparable<Value>
+    class BucketQueue {
+    private:
+        using Key = std::make_unsigned_t<Priority>;
+        using Buckets = __Util__Impl::BucketSet<Value, Priority>;
+
+        /* Key k lives in bucket k % (spread + 1), and since the keys present span at
+         * most spread + 1 values, each bucket holds a single priority. */
+        Key spread;
+        Buckets buckets;
+
+        /* The key of the last popped minimum, and so the start of the window. Before
+         * the first pop, the window starts at 0. */
+        Key last {__Util__Impl::monotone_key(Priority {0})};
+
+    public:
+        BucketQueue(Priority spread) : spread {check_spread(spread)}, buckets (static_cast<int>(this->spread) + 1)
+        {}
+
+        /* O(1), plus the distance to the next minimum. */
+        Value pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            int b {lowest_bucket()};
+            auto node {buckets.bucket(b).back().node};
+            last = __Util__Impl::monotone_key(buckets.priority(node));
+            return buckets.extract(node);
+        }
+
+        /* O(distance to the minimum) */
+        const Value& peak_min() const {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return buckets.bucket(lowest_bucket()).back().node->first;
+        }
+
+        // O(1)
+        void insert(Value v, Priority p) {
+            Key key {is_empty() ? rebase(p) : check_key(p)};
+            buckets.add(std::move(v), std::move(p), bucket_of(key));
+        }
+
+        // O(1)
+        void update_priority(const Value& v, Priority p_new) {
+            auto node {buckets.find(v)};
+            if (node == nullptr) {
+                throw MinHeapException("Tried to replace non existent value");
+            }
+
+            // Checked before the value leaves its bucket, so a throw changes nothing.
+            Key key {size() == 1 ? rebase(p_new) : check_key(p_new)};
+            auto item {buckets.take(node)};
+            item.priority = std::move(p_new);
+            buckets.put(std::move(item), bucket_of(key));
+        }
+
+        int size() const {
+            return buckets.size();
+        }
+
+        bool is_empty() const {
+            return size() == 0;
+        }
+
+        bool contains(const Value& v) const {
+            return buckets.find(v) != nullptr;
+        }
+
+        Priority get_priority(const Value& v) const {
+            auto node {buckets.find(v)};
+            if (node == nullptr)
+                throw MinHeapException("Tried to get priority of nonexistent value");
+
+            return buckets.priority(node);
+        }
+
+        // O(1)
+        void remove(const Value& v) {
+            auto node {buckets.find(v)};
+            if (node == nullptr)
+                throw MinHeapException("Tried to remove nonexistent value");
+
+            buckets.extract(node);
+        }
+
+        Priority get_spread() const {
+            return static_cast<Priority>(spread);
+        }
+
+    private:
+        int bucket_of(Key key) const {
+            return static_cast<int>(key % (spread + 1));
+        }
+
+        /* The queue is not empty, so this stops within one lap. */
+        int lowest_bucket() const {
+            int b {bucket_of(last)};
+            while (buckets.bucket(b).empty()) {
+                b = b == static_cast<int>(spread) ? 0 : b + 1;
+            }
+            return b;
+        }
+
+        Key check_key(const Priority& p) const {
+            Key key {__Util__Impl::monotone_key(p)};
+            if (key < last || key - last > spread)
+                throw MinHeapException("Priority " + std::to_string(p) + " is outside the queue's window.");
+            return key;
+        }
+
+        /* With at most one value in the queue, and that one moving, the window
+         * can slide to cover p. */
+        Key rebase(const Priority& p) {
+            Key key {__Util__Impl::monotone_key(p)};
+            if (key < last) {
+                last = key;
+            }
+            else if (key - last > spread) {
+                last = key - spread;
+            }
+            return key;
+        }
+
+        static Key check_spread(Priority spread) {
+            // Also keeps spread + 1 from overflowing Key and int.
+            if (std::cmp_less(spread, 0) || std::cmp_greater_equal(spread, std::numeric_limits<int>::max()))
+                throw MinHeapException("Tried to make a BucketQueue with spread " + std::to_string(spread) + ".");
+            return static_cast<Key>(spread);
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_BUCKET_QUEUE_H */
@@ -0,0 +1,152 @@
+/*
+ * min_heap/bucket_set.h
+ *
+ * The storage shared by RadixHeap and BucketQueue: values spread over numbered
+ * buckets, with a map from each value to where it is, so that contains,
+ * update_priority and remove work by value as in MinHeap. Internal.
+ */
+#ifndef jackcasey067_MIN_HEAP_BUCKET_SET_H
+#define jackcasey067_MIN_HEAP_BUCKET_SET_H
+
+#include "min_heap.h"
+
+#include <concepts>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    namespace __Util__Impl {
+        /* Maps integer priorities to unsigned keys in the same order, flipping the
+         * sign bit of signed ones, so that the queues can work on bits and
+         * distances without caring about signs or overflow. */
+        template<std::integral Priority>
+        constexpr std::make_unsigned_t<Priority> monotone_key(Priority p) {
+            using Key = std::make_unsigned_t<Priority>;
+            if constexpr (std::is_signed_v<Priority>) {
+                return static_cast<Key>(static_cast<Key>(p) ^ static_cast<Key>(Key {1} << (sizeof(Key) * 8 - 1)));
+            }
+            else {
+                return p;
+            }
+        }
+
+        template<typename Value, typename Priority>
+        class BucketSet {
+        public:
+            struct Location {
+                int bucket;
+                int index;
+            };
+
+            using Node = typename std::unordered_map<Value, Location>::value_type;
+
+            struct Item {
+                Priority priority;
+                Node* node; // Stable: unordered_map never moves its nodes.
+            };
+
+        private:
+            std::vector<std::vector<Item>> buckets;
+            std::unordered_map<Value, Location> locations;
+
+        public:
+            BucketSet(int bucket_count) : buckets (bucket_count) {}
+
+            /* Copies get their own nodes, so their items have to be pointed at them. */
+            BucketSet(const BucketSet& other) : buckets {other.buckets}, locations {other.locations} {
+                for (std::vector<Item>& bucket : buckets) {
+                    for (Item& item : bucket) {
+                        item.node = &*locations.find(item.node->first);
+                    }
+                }
+            }
+
+            BucketSet(BucketSet&& other) = default;
+
+            BucketSet& operator=(BucketSet other) {
+                std::swap(buckets, other.buckets);
+                std::swap(locations, other.locations);
+                return *this;
+            }
+
+            int size() const {
+                return locations.size();
+            }
+
+            /* Null if v is not present. */
+            Node* find(const Value& v) {
+                auto node {locations.find(v)};
+                return node == locations.end() ? nullptr : &*node;
+            }
+
+            const Node* find(const Value& v) const {
+                auto node {locations.find(v)};
+                return node == locations.end() ? nullptr : &*node;
+            }
+
+            /* Adds a new value to a bucket. Throws if it is already present. */
+            template<typename V>
+            void add(V&& v, Priority p, int bucket) {
+                auto [node, inserted] {locations.try_emplace(std::forward<V>(v), Location {bucket, 0})};
+                if (!inserted)
+                    throw MinHeapException("Tried to insert existing error.");
+
+                try {
+                    put({std::move(p), &*node}, bucket);
+                }
+                catch (...) {
+                    locations.erase(node);
+                    throw;
+                }
+            }
+
+            /* Moves an item, not currently in any bucket, into one. */
+            void put(Item item, int bucket) {
+                std::vector<Item>& items {buckets[bucket]};
+                item.node->second = {bucket, static_cast<int>(items.size())};
+                items.push_back(std::move(item));
+            }
+
+            /* Takes a value's item out of its bucket, leaving it in the map. O(1) */
+            Item take(Node* node) {
+                auto [bucket, index] {node->second};
+                std::vector<Item>& items {buckets[bucket]};
+
+                Item item {std::move(items[index])};
+                if (index != static_cast<int>(items.size()) - 1) {
+                    items[index] = std::move(items.back());
+                    items[index].node->second.index = index;
+                }
+                items.pop_back();
+                return item;
+            }
+
+            /* Takes a value out of its bucket and out of the map. */
+            Value extract(Node* node) {
+                take(node);
+                return std::move(locations.extract(node->first).key());
+            }
+
+            const Priority& priority(const Node* node) const {
+                return buckets[node->second.bucket][node->second.index].priority;
+            }
+
+            std::vector<Item>& bucket(int b) {
+                return buckets[b];
+            }
+
+            const std::vector<Item>& bucket(int b) const {
+                return buckets[b];
+            }
+
+            int bucket_count() const {
+                return buckets.size();
+            }
+        };
+    }
+}
+
+#endif /* jackcasey067_MIN_HEAP_BUCKET_SET_H */
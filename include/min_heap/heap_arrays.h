@@ -0,0 +1,211 @@
+/*
+ * min_heap/heap_arrays.h
+ *
+ * The array part of the d-ary heaps in this module. Internal.
+ *
+ * Entries are kept as a structure of arrays: priorities in one array, and handles
+ * (whatever the owning heap uses to find a value) in another, in the same order.
+ * Sifting compares only priorities, so it streams through dense priority data,
+ * and a cache line holds as many priorities as fit rather than as many whole
+ * entries.
+ */
+#ifndef jackcasey067_MIN_HEAP_HEAP_ARRAYS_H
+#define jackcasey067_MIN_HEAP_HEAP_ARRAYS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    namespace __Util__Impl {
+        constexpr std::size_t cache_line {64};
+
+        /* Allocates arrays of T shifted so that element 1 starts a cache line. In a
+         * d-ary heap the children of i are d*i+1 through d*i+d, so when d * sizeof(T)
+         * is a line, every group of siblings is exactly one line, and finding the
+         * smallest child costs one miss instead of two. */
+        template<typename T>
+        struct ChildAlignedAllocator {
+            static_assert(alignof(T) <= cache_line, "ChildAlignedAllocator cannot over-align T.");
+
+            using value_type = T;
+
+            static constexpr std::size_t shift {(cache_line - sizeof(T) % cache_line) % cache_line};
+
+            ChildAlignedAllocator() = default;
+
+            template<typename U>
+            ChildAlignedAllocator(const ChildAlignedAllocator<U>&) {}
+
+            T* allocate(std::size_t n) {
+                if (n > (std::numeric_limits<std::size_t>::max() - shift) / sizeof(T)) {
+                    throw std::bad_array_new_length();
+                }
+                std::byte* line {static_cast<std::byte*>(::operator new(n * sizeof(T) + shift, std::align_val_t {cache_line}))};
+                return reinterpret_cast<T*>(line + shift);
+            }
+
+            void deallocate(T* p, std::size_t) {
+                ::operator delete(reinterpret_cast<std::byte*>(p) - shift, std::align_val_t {cache_line});
+            }
+
+            template<typename U>
+            bool operator==(const ChildAlignedAllocator<U>&) const {
+                return true;
+            }
+        };
+
+        /* Whenever an entry lands at a new index, the heap calls on_move(handle, index),
+         * so that the owner can keep its own record of where each value is. */
+        template<typename Priority, typename Handle, int Arity>
+        class HeapArrays {
+        public:
+            std::vector<Priority, ChildAlignedAllocator<Priority>> priorities;
+            std::vector<Handle> handles;
+
+            int size() const {
+                return priorities.size();
+            }
+
+            bool empty() const {
+                return priorities.empty();
+            }
+
+            void reserve(std::size_t count) {
+                priorities.reserve(count);
+                handles.reserve(count);
+            }
+
+            void clear() {
+                priorities.clear();
+                handles.clear();
+            }
+
+            /* Adds an entry at the end, without restoring the heap property. */
+            void append(Priority p, Handle h) {
+                priorities.push_back(std::move(p));
+                try {
+                    handles.push_back(std::move(h));
+                }
+                catch (...) {
+                    priorities.pop_back();
+                    throw;
+                }
+            }
+
+            // O(log n)
+            template<typename OnMove>
+            void push(Priority p, Handle h, OnMove on_move) {
+                append(std::move(p), std::move(h));
+                sift_up(size() - 1, on_move);
+            }
+
+            /* Removes the entry at index; read its handle first. O(log n) */
+            template<typename OnMove>
+            void erase(int index, OnMove on_move) {
+                Priority last_priority {std::move(priorities.back())};
+                Handle last_handle {std::move(handles.back())};
+                priorities.pop_back();
+                handles.pop_back();
+
+                if (index < size()) {
+                    bool decreased {last_priority < priorities[index]};
+                    priorities[index] = std::move(last_priority);
+                    handles[index] = std::move(last_handle);
+                    if (decreased) {
+                        sift_up(index, on_move);
+                    }
+                    else {
+                        sift_down(index, on_move);
+                    }
+                }
+            }
+
+            /* Sifts only in the direction the priority moved. O(log n) */
+            template<typename OnMove>
+            void set_priority(int index, Priority p, OnMove on_move) {
+                bool decreased {p < priorities[index]};
+                priorities[index] = std::move(p);
+                if (decreased) {
+                    sift_up(index, on_move);
+                }
+                else {
+                    sift_down(index, on_move);
+                }
+            }
+
+            // Builds heap out of n elements all at once. O(n)
+            template<typename OnMove>
+            void heapify(OnMove on_move) {
+                // Iterate backwards over all nodes
+                for (int i {size() - 1}; i >= 0; i--) {
+                    sift_down(i, on_move);
+                }
+            }
+
+            /* Both sifts lift the moving entry out, leaving a hole, and shift entries
+             * into the hole until the moving entry fits there. */
+
+            // O(Arity * log n). The children are adjacent, so this is one pass over
+            // (usually) one cache line of priorities per level.
+            template<typename OnMove>
+            void sift_down(int index, OnMove& on_move) {
+                const int count {size()};
+                Priority moving_priority {std::move(priorities[index])};
+                Handle moving_handle {std::move(handles[index])};
+
+                while (true) {
+                    int first {(index * Arity) + 1};
+                    if (first >= count) {
+                        break;
+                    }
+
+                    int last {std::min(first + Arity, count)};
+                    int smallest {first};
+                    for (int child {first + 1}; child < last; child++) {
+                        if (priorities[child] < priorities[smallest]) {
+                            smallest = child;
+                        }
+                    }
+
+                    if (!(priorities[smallest] < moving_priority)) {
+                        break;
+                    }
+                    place(index, std::move(priorities[smallest]), std::move(handles[smallest]), on_move);
+                    index = smallest;
+                }
+
+                place(index, std::move(moving_priority), std::move(moving_handle), on_move);
+            }
+
+            // O(log n)
+            template<typename OnMove>
+            void sift_up(int index, OnMove& on_move) {
+                Priority moving_priority {std::move(priorities[index])};
+                Handle moving_handle {std::move(handles[index])};
+
+                while (index != 0 && moving_priority < priorities[(index - 1) / Arity]) {
+                    int parent {(index - 1) / Arity};
+                    place(index, std::move(priorities[parent]), std::move(handles[parent]), on_move);
+                    index = parent;
+                }
+
+                place(index, std::move(moving_priority), std::move(moving_handle), on_move);
+            }
+
+        private:
+            template<typename OnMove>
+            void place(int index, Priority&& p, Handle&& h, OnMove& on_move) {
+                priorities[index] = std::move(p);
+                handles[index] = std::move(h);
+                on_move(handles[index], index);
+            }
+        };
+    }
+}
+
+#endif /* jackcasey067_MIN_HEAP_HEAP_ARRAYS_H */
@@ -0,0 +1,156 @@
+/*
+ * min_heap/indexed_min_heap.h
+ *
+ * A MinHeap for dense integer keys, 0 up to some capacity, such as the vertices
+ * of a graph. Positions are kept in a flat array indexed by key instead of a
+ * hash map, so contains and update_priority are a single load, and nothing is
+ * allocated after construction.
+ */
+#ifndef jackcasey067_MIN_HEAP_INDEXED_MIN_HEAP_H
+#define jackcasey067_MIN_HEAP_INDEXED_MIN_HEAP_H
+
+#include "heap_arrays.h"
+#include "min_heap.h"
+
+#include "concepts.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    template<typename Priority = int, int Arity = 2>
+        requires HasLessThan<Priority> && (Arity >= 2)
+    class IndexedMinHeap {
+    private:
+        /* Handles are the keys themselves. */
+        __Util__Impl::HeapArrays<Priority, int, Arity> data;
+
+        /* positions[key] is the key's index in data, or -1 if it is not in the heap. */
+        std::vector<int> positions;
+
+    public:
+        /* Keys may be 0 through capacity - 1. Allocates room for all of them up front. */
+        IndexedMinHeap(int capacity) : positions (std::max(capacity, 0), -1) {
+            if (capacity < 0) {
+                throw MinHeapException("Tried to make an IndexedMinHeap with negative capacity.");
+            }
+            data.reserve(capacity);
+        }
+
+        // O(log(n))
+        int pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            int retval {data.handles[0]};
+            positions[retval] = -1;
+            data.erase(0, tracker());
+
+            return retval;
+        }
+
+        // O(1)
+        int peak_min() const {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return data.handles[0];
+        }
+
+        // O(log n)
+        void insert(int key, Priority p) {
+            check_key(key);
+            if (positions[key] != -1)
+                throw MinHeapException("Tried to insert existing key " + std::to_string(key) + ".");
+
+            data.push(std::move(p), key, tracker());
+        }
+
+        // O(log n)
+        void update_priority(int key, Priority p_new) {
+            if (!contains(key)) {
+                throw MinHeapException("Tried to replace non existent key " + std::to_string(key) + ".");
+            }
+
+            data.set_priority(positions[key], std::move(p_new), tracker());
+        }
+
+        /* Inserts key, or lowers its priority if it is already present with a higher
+         * one; the relax step of Dijkstra's algorithm. Returns true if the priority
+         * changed. O(log n) */
+        bool insert_or_decrease(int key, Priority p) {
+            check_key(key);
+            int index {positions[key]};
+            if (index == -1) {
+                data.push(std::move(p), key, tracker());
+                return true;
+            }
+            if (p < data.priorities[index]) {
+                data.set_priority(index, std::move(p), tracker());
+                return true;
+            }
+            return false;
+        }
+
+        int size() const {
+            return data.size();
+        }
+
+        bool is_empty() const {
+            return data.empty();
+        }
+
+        int get_capacity() const {
+            return positions.size();
+        }
+
+        /* False for keys outside the capacity. O(1) */
+        bool contains(int key) const {
+            return key >= 0 && key < get_capacity() && positions[key] != -1;
+        }
+
+        Priority get_priority(int key) const {
+            if (!contains(key))
+                throw MinHeapException("Tried to get priority of nonexistent key " + std::to_string(key) + ".");
+
+            return data.priorities[positions[key]];
+        }
+
+        void remove(int key) {
+            if (!contains(key))
+                throw MinHeapException("Tried to remove nonexistent key " + std::to_string(key) + ".");
+
+            int index {positions[key]};
+            positions[key] = -1;
+            data.erase(index, tracker());
+        }
+
+        /* Empties the heap, keeping its memory, in O(size) rather than O(capacity). */
+        void clear() {
+            for (int key : data.handles) {
+                positions[key] = -1;
+            }
+            data.clear();
+        }
+
+    private:
+        auto tracker() {
+            return [this](int key, int index) {
+                positions[key] = index;
+            };
+        }
+
+        void check_key(int key) const {
+            if (key < 0 || key >= get_capacity())
+                throw MinHeapException("Key " + std::to_string(key) + " is outside the capacity "
+                    + std::to_string(get_capacity()) + ".");
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_INDEXED_MIN_HEAP_H */
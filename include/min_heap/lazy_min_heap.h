@@ -0,0 +1,152 @@
+/*
+ * min_heap/lazy_min_heap.h
+ *
+ * A MinHeap for the common case of pushing values and popping them until empty,
+ * with no update_priority, remove or contains. There is no map from values to
+ * positions, so Value needs no hash, the same value may be inserted many times,
+ * and sifting never touches anything but the heap arrays.
+ *
+ * Instead of updating or removing an entry, insert the value again and let the
+ * old entry go stale: the heap takes a staleness check, and pop_min skips over
+ * entries it says are stale. In Dijkstra's algorithm, for instance, an entry is
+ * stale once its vertex has been finalized.
+ */
+#ifndef jackcasey067_MIN_HEAP_LAZY_MIN_HEAP_H
+#define jackcasey067_MIN_HEAP_LAZY_MIN_HEAP_H
+
+#include "heap_arrays.h"
+#include "min_heap.h"
+
+#include "concepts.h"
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+
+namespace Util {
+    template<typename Value, typename Priority = int, int Arity = 2>
+        requires HasLessThan<Priority> && (Arity >= 2)
+    class LazyMinHeap {
+    private:
+        /* Handles are the values themselves, and nothing tracks where they go. */
+        __Util__Impl::HeapArrays<Priority, Value, Arity> data;
+
+        /* Empty if nothing is ever stale. */
+        std::function<bool(const Value&, const Priority&)> is_stale;
+
+        static constexpr auto ignore {[](const Value&, int) {}};
+
+    public:
+        LazyMinHeap() : data {}, is_stale {}
+        {}
+
+        /* is_stale(value, priority) says whether an entry should be skipped. It is
+         * asked only about the entry at the top, and may change its mind over time,
+         * but only from not stale to stale. */
+        LazyMinHeap(std::function<bool(const Value&, const Priority&)> is_stale)
+            : data {}, is_stale {std::move(is_stale)}
+        {}
+
+        /* Skips stale entries, then pops the smallest. O(log(n)) per entry */
+        Value pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            Value retval {std::move(data.handles[0])};
+            data.erase(0, ignore);
+
+            return retval;
+        }
+
+        /* Like pop_min, but also returns the priority the value had. */
+        std::pair<Value, Priority> pop_min_with_priority() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            std::pair<Value, Priority> retval {std::move(data.handles[0]), std::move(data.priorities[0])};
+            data.erase(0, ignore);
+
+            return retval;
+        }
+
+        /* Not const, since stale entries are skipped (and so dropped) first. */
+        const Value& peak_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return data.handles[0];
+        }
+
+        const Priority& peak_priority() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return data.priorities[0];
+        }
+
+        /* Duplicates are fine. O(log n) */
+        void insert(Value v, Priority p) {
+            data.push(std::move(p), std::move(v), ignore);
+        }
+
+        /* Entries in the heap, including stale ones not yet skipped. */
+        int size() const {
+            return data.size();
+        }
+
+        /* True if every entry is gone or stale; drops stale entries from the top. */
+        bool is_empty() {
+            drop_stale();
+            return data.empty();
+        }
+
+        /* Drops every stale entry, not just those at the top, to reclaim memory
+         * when many entries have gone stale. O(n) */
+        void compact() {
+            if (!is_stale) {
+                return;
+            }
+
+            int kept {0};
+            for (int i {0}; i < size(); i++) {
+                if (!is_stale(data.handles[i], data.priorities[i])) {
+                    if (kept != i) {
+                        data.priorities[kept] = std::move(data.priorities[i]);
+                        data.handles[kept] = std::move(data.handles[i]);
+                    }
+                    kept++;
+                }
+            }
+            data.priorities.erase(data.priorities.begin() + kept, data.priorities.end());
+            data.handles.erase(data.handles.begin() + kept, data.handles.end());
+
+            data.heapify(ignore);
+        }
+
+        void reserve(std::size_t count) {
+            data.reserve(count);
+        }
+
+        void clear() {
+            data.clear();
+        }
+
+    private:
+        void drop_stale() {
+            if (!is_stale) {
+                return;
+            }
+
+            while (!data.empty() && is_stale(data.handles[0], data.priorities[0])) {
+                data.erase(0, ignore);
+            }
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_LAZY_MIN_HEAP_H */
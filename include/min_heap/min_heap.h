@@ -0,0 +1,319 @@
+/*
+ * min_heap/min_heap.h
+ *
+ * A priority queue of distinct hashable values, with update_priority, remove and
+ * contains by value.
+ */
+#ifndef jackcasey067_MIN_HEAP_MIN_HEAP_H
+#define jackcasey067_MIN_HEAP_MIN_HEAP_H
+
+#include "heap_arrays.h"
+
+#include "concepts.h"
+
+#include <concepts>
+#include <exception>
+#include <functional>
+#include <ranges>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unordered_map>
+
+
+namespace Util {
+    class MinHeapException : std::exception {
+        std::string _what;
+
+    public:
+        MinHeapException(std::string what) : _what {what} 
+        {}
+
+        const char* what() const noexcept override {
+            return _what.c_str();
+        }
+    };
+
+    /* Arity is the number of children of each node. Wider heaps are shallower, so
+     * pop_min touches fewer cache lines, at the cost of more comparisons per level;
+     * 4 is usually the sweet spot for large heaps with small entries.
+     *
+     * Each value lives in exactly one place, the node of val_to_index that holds
+     * its position. The heap itself only holds priorities, and in a parallel array,
+     * pointers to those nodes (see heap_arrays.h), so sifting reads dense priority
+     * data and never hashes, and values are never copied (they may be move only). */
+    template<Hashable Value, typename Priority = int, int Arity = 2>
+        requires std::equality_comparable<Value> && HasLessThan<Priority> && (Arity >= 2)
+    class MinHeap {
+    private:
+        using Node = typename std::unordered_map<Value, int>::value_type;
+
+        /* Handles are pointers to the nodes of val_to_index, which are stable:
+         * unordered_map never moves its nodes. */
+        __Util__Impl::HeapArrays<Priority, Node*, Arity> data;
+        std::unordered_map<Value, int> val_to_index;
+
+        static constexpr auto track {[](Node* node, int index) {
+            node->second = index;
+        }};
+
+    public:
+        MinHeap() 
+            : data {}, val_to_index {std::unordered_map<Value, int>()}
+        {}
+
+        /* Copies get their own nodes, so their handles have to be pointed at them. */
+        MinHeap(const MinHeap& other) requires std::copy_constructible<Value>
+            : data {other.data}, val_to_index {other.val_to_index}
+        {
+            for (Node*& node : data.handles) {
+                node = &*val_to_index.find(node->first);
+            }
+        }
+
+        /* Moving (or swapping) an unordered_map keeps its nodes where they are. */
+        MinHeap(MinHeap&& other) = default;
+
+        MinHeap& operator=(MinHeap other) {
+            std::swap(data, other.data);
+            std::swap(val_to_index, other.val_to_index);
+            return *this;
+        }
+
+        /* Heapify constructors, run in O(n) */
+
+        template<typename Iterator>
+            requires std::is_same<std::iter_value_t<Iterator>, std::pair<Value, Priority>>::value
+        MinHeap(Iterator begin, Iterator end) : MinHeap() {
+            for (Iterator it {begin}; it != end; it++) {
+                append(it->first, it->second);
+            }
+
+            data.heapify(track);
+        }
+
+        template<std::ranges::range Range>
+        MinHeap(Range r) : MinHeap(r.begin(), r.end())
+        {}
+
+        template<typename Iterator>
+            requires std::is_same<std::iter_value_t<Iterator>, Value>::value
+        MinHeap(Iterator begin, Iterator end, std::function<Priority(const Value&)> priority_function) : MinHeap() {
+            for (Iterator it {begin}; it != end; it++) {
+                append(*it, priority_function(*it));
+            }
+
+            data.heapify(track);
+        }
+
+        template<std::ranges::range Range>
+        MinHeap(Range r, std::function<Priority(const Value&)> priority_function) : MinHeap (r.begin(), r.end(), priority_function)
+        {}
+
+        // O(log(n))
+        Value pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            // The node leaves the map with the value still in it, so the value is
+            // moved out exactly once.
+            auto node {val_to_index.extract(data.handles[0]->first)};
+            data.erase(0, track);
+
+            return std::move(node.key());
+        }
+
+        // O(1)
+        const Value& peak_min() const {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return data.handles[0]->first;
+        }
+
+        // O(log n)
+        void insert(Value v, Priority p) {
+            auto [node, inserted] {val_to_index.try_emplace(std::move(v), size())};
+            if (!inserted)
+                throw MinHeapException("Tried to insert existing error.");
+
+            push_node(node, std::move(p));
+        }
+
+        /* Constructs the value in place from args. O(log n) */
+        template<typename... Args>
+            requires std::constructible_from<Value, Args...>
+        void emplace(Priority p, Args&&... args) {
+            auto [node, inserted] {val_to_index.emplace(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<Args>(args)...), std::forward_as_tuple(size()))};
+            if (!inserted)
+                throw MinHeapException("Tried to insert existing error.");
+
+            push_node(node, std::move(p));
+        }
+
+        /* Inserts every (value, priority) pair of items. A batch at least as big as
+         * the heap is appended and heapified, in O(n + k); smaller ones are
+         * inserted one by one, in O(k log n). If a value is already present, this
+         * throws, with the values before it inserted. */
+        template<std::ranges::forward_range Range>
+            requires std::convertible_to<std::ranges::range_reference_t<Range>, std::pair<Value, Priority>>
+        void insert_batch(Range&& items) {
+            const int count {static_cast<int>(std::ranges::distance(items))};
+            data.reserve(size() + count);
+            val_to_index.reserve(size() + count);
+
+            if (count < size()) {
+                for (auto&& element : items) {
+                    auto&& item {as_item(std::forward<decltype(element)>(element))};
+                    using Item = decltype(item);
+                    insert(std::forward<Item>(item).first, std::forward<Item>(item).second);
+                }
+                return;
+            }
+
+            try {
+                for (auto&& element : items) {
+                    auto&& item {as_item(std::forward<decltype(element)>(element))};
+                    using Item = decltype(item);
+                    append(std::forward<Item>(item).first, std::forward<Item>(item).second);
+                }
+            }
+            catch (...) {
+                data.heapify(track);
+                throw;
+            }
+            data.heapify(track);
+        }
+
+        /* Sets the priority of each value in items. When sifting every value would
+         * cost more than rebuilding (about k log n > n), the priorities are set in
+         * place and the heap is heapified once. If a value is not present, this
+         * throws, with the updates before it made. */
+        template<std::ranges::forward_range Range>
+            requires std::convertible_to<std::ranges::range_reference_t<Range>, std::pair<Value, Priority>>
+        void update_batch(Range&& items) {
+            const long long count {std::ranges::distance(items)};
+
+            if (count * depth() <= size()) {
+                for (auto&& element : items) {
+                    auto&& item {as_item(std::forward<decltype(element)>(element))};
+                    update_priority(item.first, std::forward<decltype(item)>(item).second);
+                }
+                return;
+            }
+
+            try {
+                for (auto&& element : items) {
+                    auto&& item {as_item(std::forward<decltype(element)>(element))};
+                    auto node {val_to_index.find(item.first)};
+                    if (node == val_to_index.end()) {
+                        throw MinHeapException("Tried to replace non existent value");
+                    }
+                    data.priorities[node->second] = std::forward<decltype(item)>(item).second;
+                }
+            }
+            catch (...) {
+                data.heapify(track);
+                throw;
+            }
+            data.heapify(track);
+        }
+
+        // O(log n)
+        void update_priority(const Value& v, Priority p_new) {
+            auto node {val_to_index.find(v)};
+            if (node == val_to_index.end()) {
+                throw MinHeapException("Tried to replace non existent value");
+            }
+
+            data.set_priority(node->second, std::move(p_new), track);
+        }
+
+        int size() const {
+            return data.size();
+        }
+
+        bool is_empty() const {
+            return data.empty();
+        }
+
+        bool contains(const Value& v) const {
+            return val_to_index.contains(v);
+        }
+
+        Priority get_priority(const Value& v) const {
+            if (!contains(v))
+                throw MinHeapException("Tried to get priority of nonexistent value");
+
+            return data.priorities[val_to_index.at(v)];
+        }
+
+        void remove(const Value& v) {
+            auto node {val_to_index.find(v)};
+            if (node == val_to_index.end())
+                throw MinHeapException("Tried to remove nonexistent value");
+
+            int index {node->second};
+            val_to_index.erase(node);
+            data.erase(index, track);
+        }
+
+    private:
+        /* The number of levels in the heap. */
+        int depth() const {
+            int levels {0};
+            for (long long width {1}, total {0}; total < size(); width *= Arity, levels++) {
+                total += width;
+            }
+            return levels;
+        }
+
+        /* A batch element as a (value, priority) pair. Elements that already are
+         * one are passed through as they are, so nothing is copied that need not
+         * be, and prvalue or rvalue elements can be moved from. */
+        template<typename Element>
+        static decltype(auto) as_item(Element&& element) {
+            if constexpr (std::is_same_v<std::remove_cvref_t<Element>, std::pair<Value, Priority>>) {
+                return std::forward<Element>(element);
+            }
+            else {
+                return std::pair<Value, Priority>(std::forward<Element>(element));
+            }
+        }
+
+        /* Adds a value at the end, without restoring the heap property. */
+        template<typename V>
+        void append(V&& v, Priority p) {
+            auto [node, inserted] {val_to_index.try_emplace(std::forward<V>(v), size())};
+            if (!inserted)
+                throw MinHeapException("Tried to insert existing error.");
+
+            try {
+                data.append(std::move(p), &*node);
+            }
+            catch (...) {
+                val_to_index.erase(node);
+                throw;
+            }
+        }
+
+        template<typename Iterator>
+        void push_node(Iterator node, Priority p) {
+            try {
+                data.append(std::move(p), &*node);
+            }
+            catch (...) {
+                val_to_index.erase(node);
+                throw;
+            }
+            data.sift_up(size() - 1, track);
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_MIN_HEAP_H */
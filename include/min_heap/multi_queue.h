@@ -0,0 +1,249 @@
+/*
+ * min_heap/multi_queue.h
+ *
+ * A relaxed concurrent priority queue (a MultiQueue): several shards, each a
+ * LazyMinHeap behind its own lock, a few per thread. insert goes to a random
+ * shard, and pop takes the better top of two random shards, so threads rarely
+ * meet on the same lock, and none of them serialize on one heap.
+ *
+ * In exchange, pops are only roughly in order: what comes out is usually among
+ * the smallest few (about the number of shards) priorities, not always the
+ * smallest. That suits parallel shortest paths and schedulers, which tolerate
+ * a little disorder (see get_stats for how much there was).
+ */
+#ifndef jackcasey067_MIN_HEAP_MULTI_QUEUE_H
+#define jackcasey067_MIN_HEAP_MULTI_QUEUE_H
+
+#include "heap_arrays.h"
+#include "lazy_min_heap.h"
+#include "min_heap.h"
+
+#include "concepts.h"
+
+#include <base_classes/noncopyable.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    /* Totals over all shards. They are read without locking, so are only
+     * approximate while other threads are still working. */
+    struct MultiQueueStats {
+        std::uint64_t inserts;
+        std::uint64_t pops;
+
+        /* Pops where a third, randomly sampled shard had a smaller top than the
+         * popped priority. inversions / pops estimates the chance that a pop was
+         * out of order, and times the shard count, roughly how far (the rank
+         * error). With one shard, this is always 0. */
+        std::uint64_t inversions;
+
+        /* Times a thread found a shard locked and moved on to another. */
+        std::uint64_t lock_failures;
+    };
+
+    template<typename Value, typename Priority = int, int Arity = 4>
+        requires HasLessThan<Priority> && std::is_trivially_copyable_v<Priority> && (Arity >= 2)
+    class MultiQueue : public NonCopyable {
+    private:
+        /* One per cache line, so that threads on different shards do not contend. */
+        struct alignas(__Util__Impl::cache_line) Shard {
+            std::mutex lock;
+            LazyMinHeap<Value, Priority, Arity> heap;
+
+            /* The top of heap, readable without the lock. Only meaningful when not
+             * empty. */
+            std::atomic<Priority> top {};
+            std::atomic<bool> empty {true};
+            std::atomic<int> size {0};
+
+            /* Only written with the lock held. */
+            std::atomic<std::uint64_t> inserts {0};
+            std::atomic<std::uint64_t> pops {0};
+            std::atomic<std::uint64_t> inversions {0};
+
+            std::atomic<std::uint64_t> lock_failures {0};
+        };
+
+        std::vector<Shard> shards;
+
+    public:
+        /* Makes shards_per_thread shards for each of threads threads (0 meaning one
+         * per core). is_stale is as for LazyMinHeap, and is called from many
+         * threads at once, so must be thread safe. */
+        MultiQueue(unsigned threads = 0, int shards_per_thread = 2, std::function<bool(const Value&, const Priority&)> is_stale = {})
+            : shards (shard_count(threads, shards_per_thread))
+        {
+            for (Shard& shard : shards) {
+                shard.heap = LazyMinHeap<Value, Priority, Arity> {is_stale};
+            }
+        }
+
+        /* Inserts into a random shard that is not locked. Duplicates are fine. */
+        void insert(Value v, Priority p) {
+            while (true) {
+                Shard& shard {shards[random_index(shards.size())]};
+                std::unique_lock<std::mutex> held {shard.lock, std::try_to_lock};
+                if (!held.owns_lock()) {
+                    shard.lock_failures.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                shard.heap.insert(std::move(v), p);
+                bump(shard.inserts);
+                publish_top(shard);
+                return;
+            }
+        }
+
+        /* Pops the smaller top of two random shards, with its priority. If both look
+         * empty, tries other pairs, and returns nothing only once it has seen every
+         * shard empty. */
+        std::optional<std::pair<Value, Priority>> try_pop_min() {
+            const int attempts {static_cast<int>(shards.size())};
+            for (int attempt {0}; ; attempt++) {
+                Shard* shard {attempt < attempts ? pick_two() : first_nonempty()};
+                if (shard == nullptr) {
+                    if (attempt < attempts) {
+                        continue;
+                    }
+                    return std::nullopt;
+                }
+
+                std::unique_lock<std::mutex> held {shard->lock, std::try_to_lock};
+                if (!held.owns_lock()) {
+                    shard->lock_failures.fetch_add(1, std::memory_order_relaxed);
+                    if (attempt >= attempts) {
+                        held.lock(); // Sweeping; wait rather than skip it.
+                    }
+                    else {
+                        continue;
+                    }
+                }
+
+                if (shard->heap.is_empty()) {
+                    publish_top(*shard);
+                    continue;
+                }
+
+                std::pair<Value, Priority> popped {shard->heap.pop_min_with_priority()};
+                bump(shard->pops);
+                publish_top(*shard);
+
+                Shard& witness {shards[random_index(shards.size())]};
+                if (!witness.empty.load(std::memory_order_relaxed)
+                        && witness.top.load(std::memory_order_relaxed) < popped.second) {
+                    bump(shard->inversions);
+                }
+                return popped;
+            }
+        }
+
+        /* The sum of the shards' sizes, including stale entries not yet skipped.
+         * Exact only when no other thread is working. */
+        int approximate_size() const {
+            int total {0};
+            for (const Shard& shard : shards) {
+                total += shard.size.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+        int get_shard_count() const {
+            return shards.size();
+        }
+
+        MultiQueueStats get_stats() const {
+            MultiQueueStats stats {0, 0, 0, 0};
+            for (const Shard& shard : shards) {
+                stats.inserts += shard.inserts.load(std::memory_order_relaxed);
+                stats.pops += shard.pops.load(std::memory_order_relaxed);
+                stats.inversions += shard.inversions.load(std::memory_order_relaxed);
+                stats.lock_failures += shard.lock_failures.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+        /* Not safe to call while other threads use the queue. */
+        void reset_stats() {
+            for (Shard& shard : shards) {
+                shard.inserts.store(0, std::memory_order_relaxed);
+                shard.pops.store(0, std::memory_order_relaxed);
+                shard.inversions.store(0, std::memory_order_relaxed);
+                shard.lock_failures.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        static std::size_t shard_count(unsigned threads, int shards_per_thread) {
+            if (shards_per_thread < 1)
+                throw MinHeapException("Tried to make a MultiQueue with " + std::to_string(shards_per_thread) + " shards per thread.");
+
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            return static_cast<std::size_t>(threads) * shards_per_thread;
+        }
+
+        static std::size_t random_index(std::size_t count) {
+            thread_local std::minstd_rand rng {std::random_device {}()};
+            return rng() % count;
+        }
+
+        /* The one of two distinct random shards with the smaller top, or null if
+         * both look empty. */
+        Shard* pick_two() {
+            std::size_t i {random_index(shards.size())};
+            std::size_t j {shards.size() == 1 ? i : random_index(shards.size() - 1)};
+            if (shards.size() > 1 && j >= i) {
+                j++;
+            }
+
+            Shard* a {&shards[i]};
+            Shard* b {&shards[j]};
+            bool a_empty {a->empty.load(std::memory_order_relaxed)};
+            bool b_empty {b->empty.load(std::memory_order_relaxed)};
+            if (a_empty || b_empty) {
+                return a_empty ? (b_empty ? nullptr : b) : a;
+            }
+            return b->top.load(std::memory_order_relaxed) < a->top.load(std::memory_order_relaxed) ? b : a;
+        }
+
+        Shard* first_nonempty() {
+            for (Shard& shard : shards) {
+                if (!shard.empty.load(std::memory_order_acquire)) {
+                    return &shard;
+                }
+            }
+            return nullptr;
+        }
+
+        /* Updates what other threads see of a shard. Call with its lock held. */
+        static void publish_top(Shard& shard) {
+            bool empty {shard.heap.is_empty()};
+            if (!empty) {
+                shard.top.store(shard.heap.peak_priority(), std::memory_order_relaxed);
+            }
+            shard.size.store(shard.heap.size(), std::memory_order_relaxed);
+            shard.empty.store(empty, std::memory_order_release);
+        }
+
+        /* Counters are only written under the shard's lock, so need no atomic add. */
+        static void bump(std::atomic<std::uint64_t>& counter) {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_MULTI_QUEUE_H */
@@ -0,0 +1,126 @@
+/*
+ * min_heap/node_pool.h
+ *
+ * A pool of fixed size objects for the node based heaps in this module. Internal.
+ *
+ * Nodes are carved out of chunks, each twice the size of the last, and freed
+ * nodes go onto a free list for reuse, so a steady state heap allocates nothing,
+ * and neighbouring nodes tend to share cache lines. A pool can absorb another in
+ * O(1), which lets heaps meld without moving any nodes.
+ */
+#ifndef jackcasey067_MIN_HEAP_NODE_POOL_H
+#define jackcasey067_MIN_HEAP_NODE_POOL_H
+
+#include <base_classes/noncopyable.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+namespace Util {
+    namespace __Util__Impl {
+        /* The pool never runs destructors itself: whoever creates an object must
+         * destroy it, before the pool goes away. */
+        template<typename T>
+        class NodePool : public NonCopyable {
+        private:
+            union Slot {
+                Slot* next_free;
+                alignas(T) std::byte storage[sizeof(T)];
+            };
+
+            std::list<std::unique_ptr<Slot[]>> chunks;
+            std::size_t next_chunk_size {32};
+
+            Slot* free_head {nullptr};
+            Slot* free_tail {nullptr};
+
+        public:
+            NodePool() = default;
+
+            NodePool(NodePool&& other)
+                : chunks {std::move(other.chunks)}, next_chunk_size {other.next_chunk_size},
+                  free_head {std::exchange(other.free_head, nullptr)}, free_tail {std::exchange(other.free_tail, nullptr)}
+            {}
+
+            NodePool& operator=(NodePool&& other) {
+                chunks = std::move(other.chunks);
+                next_chunk_size = other.next_chunk_size;
+                free_head = std::exchange(other.free_head, nullptr);
+                free_tail = std::exchange(other.free_tail, nullptr);
+                return *this;
+            }
+
+            template<typename... Args>
+            T* create(Args&&... args) {
+                if (free_head == nullptr) {
+                    grow();
+                }
+
+                Slot* slot {free_head};
+                free_head = slot->next_free;
+                if (free_head == nullptr) {
+                    free_tail = nullptr;
+                }
+
+                try {
+                    return ::new (static_cast<void*>(slot->storage)) T(std::forward<Args>(args)...);
+                }
+                catch (...) {
+                    release(slot);
+                    throw;
+                }
+            }
+
+            void destroy(T* object) {
+                object->~T();
+                release(reinterpret_cast<Slot*>(object));
+            }
+
+            /* Takes over all of other's memory, including the objects still living
+             * in it. O(1) */
+            void absorb(NodePool& other) {
+                chunks.splice(chunks.end(), other.chunks);
+                next_chunk_size = std::max(next_chunk_size, other.next_chunk_size);
+
+                if (other.free_head != nullptr) {
+                    other.free_tail->next_free = free_head;
+                    if (free_head == nullptr) {
+                        free_tail = other.free_tail;
+                    }
+                    free_head = other.free_head;
+                    other.free_head = other.free_tail = nullptr;
+                }
+            }
+
+        private:
+            void release(Slot* slot) {
+                slot->next_free = free_head;
+                free_head = slot;
+                if (free_tail == nullptr) {
+                    free_tail = slot;
+                }
+            }
+
+            void grow() {
+                chunks.push_back(std::make_unique_for_overwrite<Slot[]>(next_chunk_size));
+                Slot* chunk {chunks.back().get()};
+
+                for (std::size_t i {0}; i + 1 < next_chunk_size; i++) {
+                    chunk[i].next_free = &chunk[i + 1];
+                }
+                chunk[next_chunk_size - 1].next_free = nullptr;
+
+                free_head = chunk;
+                free_tail = &chunk[next_chunk_size - 1];
+                next_chunk_size *= 2;
+            }
+        };
+    }
+}
+
+#endif /* jackcasey067_MIN_HEAP_NODE_POOL_H */
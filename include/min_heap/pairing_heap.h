@@ -0,0 +1,288 @@
+/*
+ * min_heap/pairing_heap.h
+ *
+ * A pairing heap: a tree of nodes where every node's priority is at most its
+ * children's. insert and meld just link two trees, in O(1), and lowering a
+ * priority cuts the node's subtree out and links it back at the root, in
+ * amortized o(log n), which suits Prim's and Dijkstra's algorithms on dense
+ * graphs, where decreases far outnumber pops.
+ *
+ * Values are found by the Handle that insert returns rather than by value, so
+ * there is no hash map, and Value needs no hash or equality.
+ */
+#ifndef jackcasey067_MIN_HEAP_PAIRING_HEAP_H
+#define jackcasey067_MIN_HEAP_PAIRING_HEAP_H
+
+#include "min_heap.h"
+#include "node_pool.h"
+
+#include "concepts.h"
+
+#include <base_classes/noncopyable.h>
+
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    template<typename Value, typename Priority = int>
+        requires HasLessThan<Priority>
+    class PairingHeap : public NonCopyable {
+    private:
+        struct Node {
+            Value value;
+            Priority priority;
+
+            Node* child {nullptr};
+            Node* next {nullptr}; // The next sibling.
+            Node* prev {nullptr}; // The previous sibling, or the parent of a first child.
+        };
+
+        __Util__Impl::NodePool<Node> pool;
+        Node* root {nullptr};
+        int count {0};
+
+    public:
+        /* Refers to one value in the heap (or in any heap it is melded into), until
+         * that value is popped or removed. Using it after that is undefined, as
+         * with an iterator to an erased element. */
+        class Handle {
+        private:
+            friend class PairingHeap;
+
+            Node* node {nullptr};
+
+            Handle(Node* node) : node {node} {}
+
+        public:
+            Handle() = default;
+
+            bool operator==(const Handle& other) const = default;
+        };
+
+        PairingHeap() = default;
+
+        PairingHeap(PairingHeap&& other)
+            : pool {std::move(other.pool)}, root {std::exchange(other.root, nullptr)}, count {std::exchange(other.count, 0)}
+        {}
+
+        PairingHeap& operator=(PairingHeap&& other) {
+            if (this != &other) {
+                clear();
+                pool = std::move(other.pool);
+                root = std::exchange(other.root, nullptr);
+                count = std::exchange(other.count, 0);
+            }
+            return *this;
+        }
+
+        ~PairingHeap() {
+            clear();
+        }
+
+        // O(1)
+        Handle insert(Value v, Priority p) {
+            Node* node {pool.create(std::move(v), std::move(p))};
+            root = root == nullptr ? node : link(root, node);
+            count++;
+            return node;
+        }
+
+        // Amortized O(log n)
+        Value pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            Node* old_root {root};
+            root = merge_pairs(old_root->child);
+            return take(old_root);
+        }
+
+        // O(1)
+        const Value& peak_min() const {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return root->value;
+        }
+
+        /* Lowering a priority is amortized o(log n), raising one is amortized
+         * O(log n), as the node's children have to be merged. */
+        void update_priority(Handle h, Priority p_new) {
+            Node* node {check_handle(h)};
+
+            if (p_new < node->priority) {
+                node->priority = std::move(p_new);
+                if (node != root) {
+                    cut(node);
+                    root = link(root, node);
+                }
+            }
+            else {
+                detach(node);
+                node->priority = std::move(p_new);
+                root = root == nullptr ? node : link(root, node);
+            }
+        }
+
+        /* Moves every value of other into this heap, leaving other empty. Handles
+         * into other now refer to the same values in this heap. O(1) */
+        void meld(PairingHeap& other) {
+            if (&other == this || other.root == nullptr) {
+                return;
+            }
+
+            pool.absorb(other.pool);
+            root = root == nullptr ? other.root : link(root, other.root);
+            count += std::exchange(other.count, 0);
+            other.root = nullptr;
+        }
+
+        // Amortized O(log n)
+        void remove(Handle h) {
+            Node* node {check_handle(h)};
+            detach(node);
+            take(node);
+        }
+
+        const Value& get_value(Handle h) const {
+            return check_handle(h)->value;
+        }
+
+        const Priority& get_priority(Handle h) const {
+            return check_handle(h)->priority;
+        }
+
+        int size() const {
+            return count;
+        }
+
+        bool is_empty() const {
+            return count == 0;
+        }
+
+        /* Destroys every value, keeping the pool's memory. O(n) */
+        void clear() {
+            std::vector<Node*> stack {};
+            if (root != nullptr) {
+                stack.push_back(root);
+            }
+            while (!stack.empty()) {
+                Node* node {stack.back()};
+                stack.pop_back();
+                for (Node* child {node->child}; child != nullptr; child = child->next) {
+                    stack.push_back(child);
+                }
+                pool.destroy(node);
+            }
+            root = nullptr;
+            count = 0;
+        }
+
+    private:
+        static Node* check_handle(Handle h) {
+            if (h.node == nullptr)
+                throw MinHeapException("Tried to use an empty handle.");
+            return h.node;
+        }
+
+        /* Makes the root with the larger priority the first child of the other,
+         * and returns the new root. Both arguments must be roots. O(1) */
+        static Node* link(Node* a, Node* b) {
+            if (b->priority < a->priority) {
+                std::swap(a, b);
+            }
+
+            b->next = a->child;
+            if (a->child != nullptr) {
+                a->child->prev = b;
+            }
+            b->prev = a;
+            a->child = b;
+
+            a->next = nullptr;
+            a->prev = nullptr;
+            return a;
+        }
+
+        /* Links a list of siblings into one tree, by linking them in pairs from left
+         * to right, then linking the pairs from right to left. This two pass order
+         * is what gives the heap its amortized bounds. */
+        static Node* merge_pairs(Node* first) {
+            if (first == nullptr) {
+                return nullptr;
+            }
+
+            // The first pass collects the pairs into a list, last pair first.
+            Node* pairs {nullptr};
+            while (first != nullptr) {
+                Node* a {first};
+                Node* b {a->next};
+                if (b == nullptr) {
+                    a->next = pairs;
+                    pairs = a;
+                    break;
+                }
+                first = b->next;
+
+                Node* pair {link(a, b)};
+                pair->next = pairs;
+                pairs = pair;
+            }
+
+            Node* result {pairs};
+            pairs = pairs->next;
+            while (pairs != nullptr) {
+                Node* following {pairs->next};
+                result = link(result, pairs);
+                pairs = following;
+            }
+            result->prev = nullptr;
+            result->next = nullptr;
+            return result;
+        }
+
+        /* Unhooks a non root node, with its subtree, from its parent. O(1) */
+        static void cut(Node* node) {
+            if (node->prev->child == node) {
+                node->prev->child = node->next;
+            }
+            else {
+                node->prev->next = node->next;
+            }
+            if (node->next != nullptr) {
+                node->next->prev = node->prev;
+            }
+            node->next = nullptr;
+            node->prev = nullptr;
+        }
+
+        /* Takes node out of the tree on its own, merging its children back in.
+         * Amortized O(log n) */
+        void detach(Node* node) {
+            if (node == root) {
+                root = merge_pairs(node->child);
+            }
+            else {
+                cut(node);
+                Node* children {merge_pairs(node->child)};
+                if (children != nullptr) {
+                    root = link(root, children);
+                }
+            }
+            node->child = nullptr;
+        }
+
+        /* Frees a node that is no longer in the tree, returning its value. */
+        Value take(Node* node) {
+            Value value {std::move(node->value)};
+            pool.destroy(node);
+            count--;
+            return value;
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_PAIRING_HEAP_H */
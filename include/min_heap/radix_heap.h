@@ -0,0 +1,180 @@
+/*
+ * min_heap/radix_heap.h
+ *
+ * A priority queue for integer priorities that never go below the last popped
+ * minimum, as in Dijkstra's algorithm or an event simulation. Values are sorted
+ * into buckets by the highest bit where their priority differs from the last
+ * minimum, so nothing is ever compared against its neighbours; each value moves
+ * down at most once per bit of the priority type, for amortized O(log C) per
+ * operation, where C is the spread of the priorities.
+ */
+#ifndef jackcasey067_MIN_HEAP_RADIX_HEAP_H
+#define jackcasey067_MIN_HEAP_RADIX_HEAP_H
+
+#include "bucket_set.h"
+#include "min_heap.h"
+
+#include "concepts.h"
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace Util {
+    /* Has the interface of MinHeap. Inserting (or updating to) a priority below
+     * the last popped minimum throws, except into an empty heap, which lowers its
+     * bound to the new priority. */
+    template<Hashable Value, std::integral Priority = int>
+        requires std::equality_comparable<Value>
+    class RadixHeap {
+    private:
+        using Key = std::make_unsigned_t<Priority>;
+        using Buckets = __Util__Impl::BucketSet<Value, Priority>;
+        using Item = typename Buckets::Item;
+
+        /* Bucket 0 holds keys equal to last; bucket b holds keys whose highest bit
+         * differing from last is bit b - 1. */
+        Buckets buckets {sizeof(Key) * 8 + 1};
+
+        /* The key of the last popped minimum. Every key in the heap is at least this. */
+        Key last {0};
+
+    public:
+        /* Amortized O(log C) */
+        Value pop_min() {
+            if (is_empty()) {
+                throw MinHeapException("Tried to pop from empty queue.");
+            }
+
+            if (buckets.bucket(0).empty()) {
+                redistribute(lowest_bucket());
+            }
+
+            return buckets.extract(buckets.bucket(0).back().node);
+        }
+
+        /* O(size of the lowest bucket), since only pop_min moves things between
+         * buckets. */
+        const Value& peak_min() const {
+            if (is_empty()) {
+                throw MinHeapException("Tried to peak from empty queue.");
+            }
+
+            return minimum(buckets.bucket(lowest_bucket())).node->first;
+        }
+
+        // O(1)
+        void insert(Value v, Priority p) {
+            Key key {check_key(p)};
+            buckets.add(std::move(v), std::move(p), bucket_of(key));
+        }
+
+        // O(1)
+        void update_priority(const Value& v, Priority p_new) {
+            auto node {buckets.find(v)};
+            if (node == nullptr) {
+                throw MinHeapException("Tried to replace non existent value");
+            }
+
+            // Checked before the value leaves its bucket, so a throw changes nothing.
+            Key key {buckets.size() == 1 ? rebase(p_new) : check_key(p_new)};
+            Item item {buckets.take(node)};
+            item.priority = std::move(p_new);
+            buckets.put(std::move(item), bucket_of(key));
+        }
+
+        int size() const {
+            return buckets.size();
+        }
+
+        bool is_empty() const {
+            return size() == 0;
+        }
+
+        bool contains(const Value& v) const {
+            return buckets.find(v) != nullptr;
+        }
+
+        Priority get_priority(const Value& v) const {
+            auto node {buckets.find(v)};
+            if (node == nullptr)
+                throw MinHeapException("Tried to get priority of nonexistent value");
+
+            return buckets.priority(node);
+        }
+
+        // O(1)
+        void remove(const Value& v) {
+            auto node {buckets.find(v)};
+            if (node == nullptr)
+                throw MinHeapException("Tried to remove nonexistent value");
+
+            buckets.extract(node);
+        }
+
+    private:
+        int bucket_of(Key key) const {
+            return std::bit_width(static_cast<Key>(key ^ last));
+        }
+
+        int lowest_bucket() const {
+            int b {0};
+            while (buckets.bucket(b).empty()) {
+                b++;
+            }
+            return b;
+        }
+
+        /* The last of the smallest items. redistribute moves items into bucket 0 in
+         * order, so this is the one pop_min takes from its back, and peak_min and
+         * pop_min agree on ties. */
+        static const Item& minimum(const std::vector<Item>& items) {
+            const Item* min {&items[0]};
+            for (const Item& item : items) {
+                if (!(min->priority < item.priority)) {
+                    min = &item;
+                }
+            }
+            return *min;
+        }
+
+        /* Makes the smallest key in bucket b the new last. Everything in b shares
+         * the bits above b - 1 with the new last, so lands in a lower bucket, and
+         * the minimum itself lands in bucket 0. Higher buckets are unaffected. */
+        void redistribute(int b) {
+            std::vector<Item> items {std::move(buckets.bucket(b))};
+            buckets.bucket(b).clear();
+
+            last = __Util__Impl::monotone_key(minimum(items).priority);
+            for (Item& item : items) {
+                int target {bucket_of(__Util__Impl::monotone_key(item.priority))};
+                buckets.put(std::move(item), target);
+            }
+        }
+
+        Key check_key(const Priority& p) {
+            if (is_empty()) {
+                return rebase(p);
+            }
+
+            Key key {__Util__Impl::monotone_key(p)};
+            if (key < last)
+                throw MinHeapException("Priority is below the last popped minimum.");
+            return key;
+        }
+
+        /* With at most one value in the heap, and that one moving, last can be
+         * lowered to p. */
+        Key rebase(const Priority& p) {
+            Key key {__Util__Impl::monotone_key(p)};
+            last = std::min(last, key);
+            return key;
+        }
+    };
+}
+
+#endif /* jackcasey067_MIN_HEAP_RADIX_HEAP_H */
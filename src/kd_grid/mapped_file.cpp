@@ -0,0 +1,85 @@
+
+#include "kd_grid/mapped_file.h"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace Util {
+    MappedFile::MappedFile(const std::string& path, MapMode mode) : mode {mode} {
+        int fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "MappedFile: Could not open " + path);
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            int error {errno};
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "MappedFile: Could not stat " + path);
+        }
+        length = static_cast<std::size_t>(info.st_size);
+
+        if (length != 0) {
+            int protection {mode == MapMode::ReadOnly ? PROT_READ : PROT_READ | PROT_WRITE};
+            void* mapped {::mmap(nullptr, length, protection, MAP_PRIVATE, fd, 0)};
+            if (mapped == MAP_FAILED) {
+                int error {errno};
+                ::close(fd);
+                throw std::system_error(error, std::generic_category(), "MappedFile: Could not map " + path);
+            }
+            memory = static_cast<std::byte*>(mapped);
+        }
+
+        // The mapping keeps its own reference to the file.
+        ::close(fd);
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : memory {std::exchange(other.memory, nullptr)}, length {std::exchange(other.length, 0)}, mode {other.mode}
+    {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            memory = std::exchange(other.memory, nullptr);
+            length = std::exchange(other.length, 0);
+            mode = other.mode;
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    std::byte* MappedFile::data() {
+        return memory;
+    }
+
+    const std::byte* MappedFile::data() const {
+        return memory;
+    }
+
+    std::size_t MappedFile::size() const {
+        return length;
+    }
+
+    MapMode MappedFile::get_mode() const {
+        return mode;
+    }
+
+    void MappedFile::unmap() {
+        if (memory != nullptr) {
+            ::munmap(memory, length);
+            memory = nullptr;
+            length = 0;
+        }
+    }
+}
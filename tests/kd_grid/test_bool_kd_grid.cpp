@@ -0,0 +1,169 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <iostream>
+#include <random>
+
+
+void test_basic() {
+    Util::KDGrid<bool, 3> grid {{-5, 5, 0, 2, -70, 70}};
+
+    assert(grid.count() == 0);
+    assert((!grid[{0, 0, 0}]));
+
+    grid[{-5, 0, -70}] = true;
+    grid[{5, 2, 70}] = true;
+    grid[{0, 1, 0}] = grid[{5, 2, 70}];
+    assert((grid[{-5, 0, -70}] && grid[{5, 2, 70}] && grid[{0, 1, 0}]));
+    assert((!grid[{-5, 0, -69}] && !grid[{4, 2, 70}]));
+    assert(grid.count() == 3);
+
+    grid[{0, 1, 0}].flip();
+    assert(grid.count() == 2);
+
+    // Default true should not leak into the padding at the end of each row.
+    Util::KDGrid<bool, 2> full {{0, 9, 0, 99}, true};
+    assert(full.count() == 1000);
+    full.flip();
+    assert(full.count() == 0);
+
+    bool caught {false};
+    try {
+        grid[{0, 3, 0}] = true;
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_regions_and_logic() {
+    Util::KDGrid<bool, 2> a {{0, 9, -100, 100}};
+    Util::KDGrid<bool, 2> b {{0, 9, -100, 100}};
+
+    a.fill({2, -90}, {7, 90}, true); // Crosses several words.
+    assert(a.count() == 6 * 181);
+    assert(a.count({0, -100}, {9, 0}) == 6 * 91);
+    assert(a.count({2, -90}, {2, -90}) == 1);
+
+    b.fill({0, 0}, {9, 3}, true);
+    assert((a & b).count() == 6 * 4);
+    assert((a | b).count() == 6 * 181 + 4 * 4);
+    assert((a ^ b).count() == 6 * 181 + 4 * 4 - 6 * 4);
+
+    a.fill({0, -100}, {9, 100}, false);
+    assert(a.count() == 0);
+
+    Util::KDGrid<bool, 2> other_shape {{0, 9, -100, 99}};
+    bool caught {false};
+    try {
+        a |= other_shape;
+    }
+    catch (std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_shift() {
+    std::mt19937 g(5);
+    Util::KDGrid<bool, 3> grid {{0, 4, 0, 5, 0, 150}};
+    for (int i {0}; i < 500; i++) {
+        grid[{static_cast<int>(g() % 5), static_cast<int>(g() % 6), static_cast<int>(g() % 151)}] = true;
+    }
+
+    for (int dimension {0}; dimension < 3; dimension++) {
+        for (int amount : {1, -1, 3, -2, 64, -65, 130, 1000}) {
+            Util::KDGrid<bool, 3> shifted {grid};
+            shifted.shift(dimension, amount);
+
+            for (int i {0}; i <= 4; i++) {
+            for (int j {0}; j <= 5; j++) {
+            for (int k {0}; k <= 150; k++) {
+                std::array<int, 3> source {i, j, k};
+                source[dimension] -= amount;
+                bool expected {grid.in_bounds(source) && grid[source]};
+                assert((shifted[{i, j, k}] == expected));
+            }}}
+        }
+    }
+}
+
+/* One step of life, 64 cells at a time: count neighbours with bitwise adders over
+ * shifted copies of the grid. */
+Util::KDGrid<bool, 2> life_step(const Util::KDGrid<bool, 2>& grid) {
+    using Grid = Util::KDGrid<bool, 2>;
+    Grid ones {grid.get_bounds()}, twos {grid.get_bounds()}, fours {grid.get_bounds()};
+
+    for (int di {-1}; di <= 1; di++) {
+        for (int dj {-1}; dj <= 1; dj++) {
+            if (di == 0 && dj == 0) {
+                continue;
+            }
+            Grid neighbour {grid};
+            neighbour.shift(0, di);
+            neighbour.shift(1, dj);
+
+            // Three bit counter; eight neighbours overflowing into bit 3 does not matter.
+            Grid carry {ones & neighbour};
+            ones ^= neighbour;
+            Grid carry2 {twos & carry};
+            twos ^= carry;
+            fours |= carry2;
+        }
+    }
+
+    // Alive next if count is 3, or count is 2 and alive now.
+    Grid next {twos};
+    Grid low {ones | grid};
+    next &= low;
+    low = fours;
+    low.flip();
+    next &= low;
+    return next;
+}
+
+void test_life() {
+    std::mt19937 g(11);
+    Util::KDGrid<bool, 2> grid {{0, 39, 0, 99}};
+    for (int i {0}; i < 1500; i++) {
+        grid[{static_cast<int>(g() % 40), static_cast<int>(g() % 100)}] = true;
+    }
+
+    for (int step {0}; step < 10; step++) {
+        Util::KDGrid<bool, 2> next {life_step(grid)};
+
+        for (int i {0}; i <= 39; i++) {
+            for (int j {0}; j <= 99; j++) {
+                int neighbours {0};
+                for (int di {-1}; di <= 1; di++) {
+                    for (int dj {-1}; dj <= 1; dj++) {
+                        if ((di != 0 || dj != 0) && grid.in_bounds({i + di, j + dj}) && grid[{i + di, j + dj}]) {
+                            neighbours++;
+                        }
+                    }
+                }
+                bool expected {neighbours == 3 || (neighbours == 2 && grid[{i, j}])};
+                assert((next[{i, j}] == expected));
+            }
+        }
+
+        grid = next;
+    }
+}
+
+
+int main() {
+    std::cout << "Testing bit packed grids...\n";
+    test_basic();
+
+    std::cout << "Testing region fill, count, and bitwise operations...\n";
+    test_regions_and_logic();
+
+    std::cout << "Testing shifts...\n";
+    test_shift();
+
+    std::cout << "Testing game of life with word parallel operations...\n";
+    test_life();
+}
@@ -0,0 +1,121 @@
+
+#include "kd_grid.h"
+
+#include <array>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/* Runs func(thread_index) on each of count threads, and waits for them. */
+template<typename Func>
+void run_threads(int count, Func func) {
+    std::vector<std::thread> threads;
+    for (int t {0}; t < count; t++) {
+        threads.emplace_back(func, t);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+void test_atomics() {
+    // Every thread scatters into the same small histogram.
+    Util::ConcurrentKDGrid<long, 2> histogram {{0, 3, 0, 3}, 0};
+    run_threads(8, [&histogram](int) {
+        for (int i {0}; i < 20000; i++) {
+            histogram.fetch_add({i % 4, (i / 4) % 4}, 1, std::memory_order_relaxed);
+        }
+    });
+    long total {0};
+    for (int i {0}; i <= 3; i++) {
+        for (int j {0}; j <= 3; j++) {
+            assert((histogram.load({i, j}) == 8 * 20000 / 16));
+            total += histogram.load({i, j});
+        }
+    }
+    assert(total == 8 * 20000);
+
+    Util::ConcurrentKDGrid<double, 1> extremes {{0, 1}, 0.0};
+    extremes.store({0}, 1e9);
+    run_threads(8, [&extremes](int t) {
+        for (int i {0}; i < 1000; i++) {
+            double value {t * 1000.0 + i - 3000};
+            extremes.fetch_min({0}, value);
+            extremes.fetch_max({1}, value);
+        }
+    });
+    assert((extremes.load({0}) == -3000.0 && extremes.load({1}) == 4999.0));
+    assert((extremes.fetch_min({0}, 5.0) == -3000.0 && extremes.load({0}) == -3000.0));
+
+    // Exactly one thread wins each cell.
+    Util::ConcurrentKDGrid<int, 3> owners {{0, 9, 0, 9, 0, 9}, -1};
+    std::vector<int> wins (8, 0);
+    run_threads(8, [&owners, &wins](int t) {
+        for (int i {0}; i < 1000; i++) {
+            int expected {-1};
+            if (owners.compare_exchange({i / 100, (i / 10) % 10, i % 10}, expected, t)) {
+                wins[t]++;
+            }
+        }
+    });
+    int claimed {0};
+    for (int count : wins) {
+        claimed += count;
+    }
+    assert(claimed == 1000);
+    assert((owners.exchange({0, 0, 0}, 42) != -1 && owners.load({0, 0, 0}) == 42));
+
+    bool caught {false};
+    try {
+        owners.fetch_add({10, 0, 0}, 1);
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_region_locks() {
+    // Strings cannot be updated atomically, so overlapping boxes are appended to
+    // under the stripe locks.
+    Util::ConcurrentKDGrid<std::string, 2> log {{-20, 19, 0, 9}, "", 4};
+    assert(log.stripe_count() == 10);
+
+    run_threads(8, [&log](int t) {
+        for (int i {0}; i < 200; i++) {
+            int start {-20 + (t * 7 + i * 3) % 30};
+            log.with_region({start, 0}, {start + 9, 9}, [](auto region) {
+                region.for_each([](const std::array<int, 2>&, std::string& cell) {
+                    cell += '.';
+                });
+            });
+            log.with_cell({19 - t, t}, [](std::string& cell) {
+                cell += '!';
+            });
+        }
+    });
+
+    std::size_t total {0};
+    log.unsynchronized().region().for_each([&total](const std::array<int, 2>&, const std::string& cell) {
+        total += cell.size();
+    });
+    assert(total == 8 * 200 * (100 + 1));
+
+    const auto& read_only {log};
+    std::size_t corner {read_only.with_region({19, 0}, {19, 0}, [](auto region) {
+        return region[{19, 0}].size();
+    })};
+    assert(corner == 200); // Only with_cell reaches the last row.
+}
+
+
+int main() {
+    std::cout << "Testing lock free atomic updates...\n";
+    test_atomics();
+
+    std::cout << "Testing striped region locks...\n";
+    test_region_locks();
+}
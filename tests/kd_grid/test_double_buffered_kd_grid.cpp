@@ -0,0 +1,136 @@
+
+#include "kd_grid.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <iostream>
+
+
+/* Conway's game of life, with everything past the edge dead. */
+template<typename Grid>
+bool life(const Grid& grid, const std::array<int, 2>& cell) {
+    int neighbours {0};
+    for (int di {-1}; di <= 1; di++) {
+        for (int dj {-1}; dj <= 1; dj++) {
+            std::array<int, 2> neighbour {cell[0] + di, cell[1] + dj};
+            if ((di != 0 || dj != 0) && grid.in_bounds(neighbour) && grid.get_unchecked(neighbour)) {
+                neighbours++;
+            }
+        }
+    }
+    return neighbours == 3 || (neighbours == 2 && grid.get_unchecked(cell));
+}
+
+void test_swap() {
+    Util::DoubleBufferedKDGrid<int, 1> counter {{0, 9}};
+    assert(!counter.is_tracking());
+    assert(counter.active_tile_count() == 1);
+
+    for (int i {0}; i <= 9; i++) {
+        counter.next()[{i}] = i;
+    }
+    const int* before {&counter.current()[{0}]};
+    counter.swap();
+    assert((counter.current()[{7}] == 7));
+    assert((&counter.next()[{0}] == before)); // The old current, not a new grid.
+
+    counter.step([](const Util::KDGrid<int, 1>& grid, const std::array<int, 1>& cell) {
+        return grid[cell] * 2;
+    }, 3);
+    assert((counter.current()[{9}] == 18 && counter.next()[{9}] == 9));
+}
+
+void test_tracked_life() {
+    const std::array<int, 4> bounds {0, 99, 0, 129};
+    Util::DoubleBufferedKDGrid<bool, 2> plain {bounds};
+    Util::DoubleBufferedKDGrid<bool, 2> tracked {bounds, false, 8};
+    assert(tracked.is_tracking() && tracked.get_tile_side() == 8);
+    assert(tracked.active_tile_count() == 13 * 17);
+
+    // A glider heading down and right, and a block, which never changes.
+    for (std::array<int, 2> cell : {std::array {1, 2}, {2, 3}, {3, 1}, {3, 2}, {3, 3}, {50, 100}, {50, 101}, {51, 100}, {51, 101}}) {
+        plain.next()[cell] = true;
+        tracked.next()[cell] = true;
+    }
+    plain.swap();
+    tracked.swap();
+    assert(tracked.active_tile_count() == 13 * 17);
+
+    for (int generation {0}; generation < 150; generation++) {
+        // Rows of a bit packed grid start on their own words, so threads are fine.
+        plain.step(life<Util::KDGrid<bool, 2>>, 4);
+        tracked.step(life<Util::KDGrid<bool, 2>>, 4);
+        assert(tracked.current() == plain.current());
+
+        // Only tiles around the glider are left to visit: a 2 by 2 block of tiles
+        // at most, dilated by one.
+        if (generation > 0) {
+            assert(tracked.active_tile_count() <= 16);
+        }
+    }
+    assert(tracked.current().count() == 5 + 4);
+    assert((tracked.current()[{50, 100}]));
+
+    tracked.mark_all_active();
+    assert(tracked.active_tile_count() == 13 * 17);
+}
+
+void test_parallel_tracking() {
+    // Heat spreading from one hot cell, a little further each step.
+    Util::DoubleBufferedKDGrid<int, 3> heat {{0, 63, 0, 63, 0, 63}, 0, 4};
+    heat.next()[{32, 32, 32}] = 1;
+    heat.swap();
+
+    for (int step {1}; step <= 10; step++) {
+        heat.step([](const Util::KDGrid<int, 3>& grid, const std::array<int, 3>& cell) {
+            int hottest {grid[cell]};
+            for (int k {0}; k < 3; k++) {
+                for (int d : {-1, 1}) {
+                    std::array<int, 3> neighbour {cell};
+                    neighbour[k] += d;
+                    if (grid.in_bounds(neighbour)) {
+                        hottest = std::max(hottest, grid[neighbour]);
+                    }
+                }
+            }
+            return hottest;
+        }, 4);
+
+        // The hot cells form an octahedron of radius step.
+        assert((heat.current()[{32 + step, 32, 32}] == 1));
+        assert((heat.current()[{32 + step, 32, 33}] == 0));
+        assert((heat.current()[{32 - 1, 32 - (step - 1), 32}] == 1));
+    }
+}
+
+/* Untracked steps never compare cells, so they need no operator==. */
+struct Unordered {
+    int value;
+};
+
+void test_without_equality() {
+    Util::DoubleBufferedKDGrid<Unordered, 2> grid {{0, 9, 0, 9}, {1}};
+    for (int step {0}; step < 3; step++) {
+        grid.step([](const Util::KDGrid<Unordered, 2>& from, const std::array<int, 2>& cell) {
+            return Unordered {from[cell].value + cell[0] * cell[1]};
+        }, 3);
+    }
+    assert((grid.current()[{4, 5}].value == 1 + 3 * 20));
+    assert((grid.current()[{0, 9}].value == 1));
+}
+
+
+int main() {
+    std::cout << "Testing O(1) swaps and untracked steps...\n";
+    test_swap();
+
+    std::cout << "Testing that tracked steps skip quiet tiles...\n";
+    test_tracked_life();
+
+    std::cout << "Testing tracked steps across threads...\n";
+    test_parallel_tracking();
+
+    std::cout << "Testing cells without operator==...\n";
+    test_without_equality();
+}
@@ -0,0 +1,95 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <iostream>
+
+
+void test_basic() {
+    Util::GrowingKDGrid<std::string, 2> grid {"."};
+
+    assert((grid.get_bounds() == std::array{0, 0, 0, 0}));
+    assert((grid[{0, 0}] == "."));
+
+    // Spiral outwards, as an expanding simulation might.
+    for (int r {1}; r <= 50; r++) {
+        grid[{r, r}] = std::to_string(r);
+        grid[{-r, r}] = std::to_string(-r);
+        grid[{0, -r}] = std::to_string(r) + "#";
+    }
+
+    assert((grid.get_bounds() == std::array{-50, 50, -50, 50}));
+    for (int k {0}; k < 2; k++) {
+        assert(grid.get_capacity()[2 * k] <= -50 && grid.get_capacity()[2 * k+1] >= 50);
+    }
+
+    // Every cell stayed where it was written.
+    for (int r {1}; r <= 50; r++) {
+        assert((grid.get({r, r}) == std::to_string(r)));
+        assert((grid.get({-r, r}) == std::to_string(-r)));
+        assert((grid.get({0, -r}) == std::to_string(r) + "#"));
+        assert((grid.get({r, -r}) == "."));
+    }
+
+    // Reading far away does not grow the grid.
+    assert((grid.get({100000, -100000}) == "."));
+    assert((grid.get_bounds() == std::array{-50, 50, -50, 50}));
+    assert((grid.in_bounds({50, -50}) && !grid.in_bounds({51, 0})));
+}
+
+void test_amortized_growth() {
+    Util::GrowingKDGrid<int, 3> grid {{0, 0, 0, 0, 0, 0}, -1};
+
+    // Reallocations happen at doublings, so capacity is at most about twice the bounds.
+    for (int i {0}; i < 1000; i++) {
+        grid[{i, -i / 2, i % 3}] = i;
+    }
+    assert((grid.get_bounds() == std::array{0, 999, -499, 0, 0, 2}));
+    assert(grid.get_capacity()[1] < 2 * 1000);
+    assert(grid.get_capacity()[2] > -2 * 500);
+
+    for (int i {0}; i < 1000; i++) {
+        assert((grid[{i, -i / 2, i % 3}] == i));
+    }
+    assert((grid.get({1, 0, 0}) == -1));
+
+    grid.reserve({-10, 2000, -500, 0, 0, 2});
+    assert((grid.get_capacity()[0] <= -10 && grid.get_capacity()[1] >= 2000));
+    assert((grid.storage()[{999, -499, 0}] == 999));
+}
+
+/* Bool grids are bit packed, so cells are proxies, and growing has to move bits
+ * between rows that start at different offsets within words. */
+void test_bool() {
+    Util::GrowingKDGrid<bool, 2> grid {};
+
+    // Spread over several words per row, and grown many times along the way.
+    int written {0};
+    for (int i {-200}; i <= 200; i += 3) {
+        grid[{i, i * 7 % 101}] = true;
+        written++;
+    }
+    grid[{-170, -170 * 7 % 101}] = false;
+    grid[{0, 0}] = true;
+    assert((grid.get_bounds() == std::array{-200, 199, -100, 99}));
+
+    for (int i {-200}; i <= 200; i += 3) {
+        assert((grid.get({i, i * 7 % 101}) == (i != -170)));
+    }
+    assert((grid[{0, 0}] && !grid.get({1, 0})));
+    assert(grid.storage().count() == static_cast<std::size_t>(written));
+
+    const Util::GrowingKDGrid<bool, 2>& read_only {grid};
+    assert((!read_only[{1000, 1000}] && read_only[{-200, -200 * 7 % 101}]));
+}
+
+int main() {
+    std::cout << "Testing growing grids...\n";
+    test_basic();
+
+    std::cout << "Testing that growth is geometric...\n";
+    test_amortized_growth();
+
+    std::cout << "Testing growing bool grids...\n";
+    test_bool();
+}
@@ -0,0 +1,271 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+
+
+void test_basic() {
+    Util::KDGrid<int, 3> grid3 {{10, 12, -10, 0, 0, 5}}; // 3D grid. You pass bounds and an (optional) default value.
+
+    for (int i {10}; i <= 12; i++) {
+        for (int j {-10}; j <= 0; j++) {
+            for (int k {0}; k <= 5; k++) {
+                assert((grid3[{i, j, k}] == 0));
+                grid3[{i, j, k}] = (i + j + k) % 10;
+                // std::cout << grid3[{i, j, k}] << ' ';
+                assert((grid3[{i, j, k}] == (i + j + k) % 10));
+            }
+            // std::cout << '\n';
+        }
+        // std::cout << '\n';
+    }
+
+    // Handles non int inner types, and other sizes...
+
+    Util::KDGrid<std::string, 5> string_grid {{-10, 10, -10, 10, -10, 10, -10, 10, -10, 10}, "Hello World"};
+
+    for (int i {-10}; i < 10; i++) {
+    for (int j {-10}; j < 10; j++) {
+    for (int k {-10}; k < 10; k++) {
+    for (int l {-10}; l < 10; l++) {
+    for (int m {-10}; m < 10; m++) {
+        assert((string_grid[{i, j, k, l, m}] == "Hello World"));
+        string_grid[{i, j, k, l, m}] = "!!!";
+        assert((string_grid[{i, j, k, l, m}] == "!!!"));
+    }}}}}
+
+    // The other indices are implicit zeros. This is not intentional, but I suppose it is fine.
+    string_grid[{1, 2, 3}] = "Goodbye";
+    assert((string_grid[{1,2,3,0,0}] == "Goodbye"));
+}
+
+void test_edge_shapes() {
+    // A single dimension, and a grid that is exactly one cell.
+    Util::KDGrid<long, 1> line {{-3, 3}, 7};
+    for (int i {-3}; i <= 3; i++) {
+        assert((line[{i}] == 7));
+        line[{i}] = i;
+    }
+    assert((line[{-3}] == -3 && line[{3}] == 3));
+
+    Util::KDGrid<int, 4> point {{2, 2, 2, 2, 2, 2, 2, 2}, 5};
+    assert((point[{2, 2, 2, 2}] == 5));
+
+    bool caught {false};
+    try {
+        Util::KDGrid<int, 2> backwards {{0, 5, 3, 2}};
+    }
+    catch (std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_out_of_range() {
+    Util::KDGrid<int, 2> grid {{0, 3, -3, 0}};
+
+    int errors_caught {0};
+    for (std::array<int, 2> indices : {std::array{4, 0}, std::array{-1, 0}, std::array{0, 1}, std::array{0, -4}}) {
+        try {
+            grid[indices] = 1;
+        }
+        catch (std::out_of_range&) {
+            errors_caught++;
+        }
+    }
+    assert(errors_caught == 4);
+}
+
+void test_unchecked_and_regions() {
+    Util::KDGrid<int, 3> grid {{-2, 2, 0, 3, 5, 9}, 1};
+
+    assert((grid.get_bounds() == std::array{-2, 2, 0, 3, 5, 9}));
+    assert(grid.size() == 5 * 4 * 5);
+    assert((grid.in_bounds({0, 0, 5}) && !grid.in_bounds({0, 0, 4})));
+
+    grid.get_unchecked({1, 2, 6}) = 42;
+    assert((grid[{1, 2, 6}] == 42));
+
+    auto region = grid.region({-1, 1, 6}, {1, 2, 8});
+    assert(region.size() == 3 * 2 * 3);
+
+    int rows {0};
+    region.for_each_row([&](const std::array<int, 3>& first, std::span<int> row) {
+        assert(first[2] == 6 && row.size() == 3);
+        for (int& cell : row) {
+            cell = 0;
+        }
+        rows++;
+    });
+    assert(rows == 3 * 2);
+
+    int visited {0};
+    region.for_each([&](const std::array<int, 3>& indices, int& cell) {
+        assert(cell == 0);
+        cell = indices[0] + indices[1] + indices[2];
+        visited++;
+    });
+    assert(visited == 18);
+    assert((region[{1, 2, 8}] == 11 && grid[{1, 2, 8}] == 11));
+
+    // Cells outside the region are untouched.
+    int sum {0};
+    const Util::KDGrid<int, 3>& const_grid {grid};
+    const_grid.region().for_each([&](const std::array<int, 3>&, const int& cell) {
+        sum += cell;
+    });
+    int expected {(100 - 18)};
+    region.for_each([&](const std::array<int, 3>&, int& cell) { expected += cell; });
+    assert(sum == expected);
+
+    int errors_caught {0};
+    try {
+        grid.region({-3, 0, 5}, {0, 0, 5});
+    }
+    catch (std::out_of_range&) {
+        errors_caught++;
+    }
+    try {
+        grid.region({0, 0, 9}, {0, 0, 5});
+    }
+    catch (std::invalid_argument&) {
+        errors_caught++;
+    }
+    assert(errors_caught == 2);
+}
+
+struct alignas(32) Padded {
+    int value {3};
+};
+
+void test_construction() {
+    // Zero cells come straight from calloc; other values are filled in parallel.
+    Util::KDGrid<int, 3> zeros {{0, 255, 0, 255, 0, 255}};
+    Util::KDGrid<int, 3> sevens {{0, 255, 0, 255, 0, 255}, 7};
+    long long sum {0};
+    sevens.region().for_each_row([&sum, &zeros](const std::array<int, 3>& first, std::span<const int> row) {
+        const int* zero_row {&zeros.get_unchecked(first)};
+        for (std::size_t i {0}; i < row.size(); i++) {
+            sum += row[i] + zero_row[i];
+        }
+    });
+    assert(sum == 7LL * 256 * 256 * 256);
+
+    Util::KDGrid<int, 3> copy {sevens};
+    assert((copy[{255, 0, 255}] == 7));
+    copy = zeros;
+    assert((copy[{255, 0, 255}] == 0 && sevens[{255, 0, 255}] == 7));
+
+    Util::KDGrid<double, 2> negative_zeros {{0, 9, 0, 9}, -0.0};
+    assert((std::signbit(negative_zeros[{9, 9}])));
+
+    Util::KDGrid<Padded, 2> padded {{0, 9, 0, 9}};
+    assert((padded[{4, 5}].value == 3));
+    assert(reinterpret_cast<std::uintptr_t>(&padded[{0, 1}]) % 32 == 0);
+}
+
+void test_fill_and_copy() {
+    Util::KDGrid<int, 3> grid {{-5, 5, 0, 9, 0, 9}, 7};
+    grid.fill(0);
+    assert((grid[{-5, 0, 0}] == 0 && grid[{5, 9, 9}] == 0));
+
+    grid.fill({-1, 2, 3}, {1, 4, 8}, -1); // Every byte the same, so a memset.
+    grid.fill({0, 0, 3}, {0, 9, 3}, 42);
+    int negatives {0};
+    grid.region().for_each([&negatives](const std::array<int, 3>&, int cell) {
+        negatives += cell == -1;
+    });
+    assert(negatives == 3 * 3 * 6 - 3);
+    assert((grid[{0, 3, 3}] == 42 && grid[{0, 0, 3}] == 42 && grid[{-1, 3, 3}] == -1 && grid[{-1, 3, 9}] == 0));
+
+    bool caught {false};
+    try {
+        grid.fill({0, 0, 0}, {0, 10, 0}, 1);
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+
+    // Blit a small stamp into the corner.
+    Util::KDGrid<int, 3> stamp {{0, 1, 0, 1, 0, 1}};
+    stamp.region().for_each([](const std::array<int, 3>& indices, int& cell) {
+        cell = 100 + indices[0] * 4 + indices[1] * 2 + indices[2];
+    });
+    grid.blit(stamp, {4, 8, 8});
+    assert((grid[{4, 8, 8}] == 100 && grid[{5, 9, 9}] == 107 && grid[{5, 8, 9}] == 105));
+
+    caught = false;
+    try {
+        grid.blit(stamp, {5, 0, 0});
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+/* Copies within one grid, where the boxes overlap, checked against a copy made
+ * through a separate grid. */
+template<typename Layout>
+void check_overlapping_copy(const std::array<int, 2>& to) {
+    Util::KDGrid<std::string, 2, Layout> grid {{0, 9, 0, 9}};
+    grid.region().for_each([](const std::array<int, 2>& indices, std::string& cell) {
+        cell = std::to_string(indices[0] * 10 + indices[1]);
+    });
+    Util::KDGrid<std::string, 2, Layout> expected {grid};
+    expected.copy_region(Util::KDGrid<std::string, 2, Layout> {grid}, {2, 2}, {6, 6}, to);
+
+    grid.copy_region(grid, {2, 2}, {6, 6}, to);
+    for (int i {0}; i <= 9; i++) {
+        for (int j {0}; j <= 9; j++) {
+            assert((grid[{i, j}] == expected[{i, j}]));
+        }
+    }
+    assert((grid[to] == "22"));
+}
+
+void test_overlapping_copy() {
+    for (std::array<int, 2> to : {std::array {3, 3}, {1, 1}, {2, 4}, {4, 0}, {0, 3}, {2, 2}}) {
+        check_overlapping_copy<Util::RowMajorLayout>(to);
+        check_overlapping_copy<Util::MortonLayout>(to);
+    }
+
+    Util::KDGrid<double, 1> line {{0, 99}};
+    for (int i {0}; i <= 99; i++) {
+        line[{i}] = i;
+    }
+    line.copy_region(line, {0}, {49}, {10});
+    assert((line[{9}] == 9 && line[{10}] == 0 && line[{59}] == 49 && line[{60}] == 60));
+    line.copy_region(line, {10}, {59}, {0});
+    assert((line[{0}] == 0 && line[{49}] == 49 && line[{50}] == 40));
+}
+
+
+int main() {
+    std::cout << "Basic Test...\n";
+    test_basic();
+
+    std::cout << "Testing single cell and single dimension grids...\n";
+    test_edge_shapes();
+
+    std::cout << "Testing out of range access...\n";
+    test_out_of_range();
+
+    std::cout << "Testing unchecked access and regions...\n";
+    test_unchecked_and_regions();
+
+    std::cout << "Testing construction of large and unusual grids...\n";
+    test_construction();
+
+    std::cout << "Testing fill, copy_region and blit...\n";
+    test_fill_and_copy();
+
+    std::cout << "Testing copies between overlapping boxes...\n";
+    test_overlapping_copy();
+}
@@ -0,0 +1,119 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <iostream>
+
+
+Util::KDGrid<int, 3> numbered_grid() {
+    Util::KDGrid<int, 3> grid {{-2, 2, 0, 4, 10, 19}};
+    grid.region().for_each([](const std::array<int, 3>& indices, int& cell) {
+        cell = indices[0] * 10000 + indices[1] * 100 + indices[2];
+    });
+    return grid;
+}
+
+void test_basic() {
+    Util::KDGrid<int, 3> grid {numbered_grid()};
+    Util::KDGridView view {grid};
+
+    assert((view.get_bounds() == grid.get_bounds()));
+    assert((view[{1, 2, 15}] == 10215));
+    assert(view.has_contiguous_rows());
+
+    // Writes go through to the grid.
+    view[{0, 0, 10}] = -1;
+    assert((grid[{0, 0, 10}] == -1));
+
+    Util::KDGridView<const int, 3> read_only {view};
+    assert((read_only[{0, 0, 10}] == -1));
+
+    const Util::KDGrid<int, 3>& const_grid {grid};
+    Util::KDGridView const_view {const_grid};
+    static_assert(std::is_same_v<decltype(const_view), Util::KDGridView<const int, 3>>);
+
+    bool caught {false};
+    try {
+        view[{3, 0, 10}];
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_subview_and_strides() {
+    Util::KDGrid<int, 3> grid {numbered_grid()};
+
+    auto box {Util::KDGridView(grid).subview({-1, 1, 12}, {1, 3, 17})};
+    assert((box.get_bounds() == std::array{-1, 1, 1, 3, 12, 17}));
+    assert((box[{-1, 1, 12}] == -10000 + 100 + 12));
+    assert(box.size() == 3 * 3 * 6);
+    assert((!box.in_bounds({-2, 1, 12})));
+
+    auto every_third {box.strided(2, 3)};
+    assert((every_third.get_bounds() == std::array{-1, 1, 1, 3, 12, 13}));
+    assert((every_third[{0, 2, 13}] == 215));
+    assert(!every_third.has_contiguous_rows());
+
+    int visited {0};
+    every_third.for_each([&visited](const std::array<int, 3>& indices, int& cell) {
+        assert(cell == indices[0] * 10000 + indices[1] * 100 + 12 + (indices[2] - 12) * 3);
+        cell = 0;
+        visited++;
+    });
+    assert(visited == 3 * 3 * 2);
+    assert((grid[{1, 3, 15}] == 0 && grid[{1, 3, 16}] == 10316));
+
+    bool caught {false};
+    try {
+        box.subview({0, 0, 12}, {0, 0, 12}); // Inside the grid, but outside the box.
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_slice_and_transpose() {
+    Util::KDGrid<int, 3> grid {numbered_grid()};
+    Util::KDGridView view {grid};
+
+    Util::KDGridView<int, 2> plane {view.slice(1, 3)};
+    assert((plane.get_bounds() == std::array{-2, 2, 10, 19}));
+    assert((plane[{-2, 19}] == -20000 + 300 + 19));
+
+    Util::KDGridView<int, 1> line {plane.slice(0, 1)};
+    assert((line[{11}] == 10311));
+
+    auto transposed {view.transpose({2, 0, 1})};
+    assert((transposed.get_bounds() == std::array{10, 19, -2, 2, 0, 4}));
+    assert((transposed[{18, -1, 4}] == -10000 + 400 + 18));
+
+    // Copying out is still possible, but explicit.
+    Util::KDGrid<int, 3> copy {transposed.to_grid()};
+    assert((copy[{18, -1, 4}] == -10000 + 400 + 18));
+    copy[{18, -1, 4}] = 0;
+    assert((grid[{-1, 4, 18}] == -10000 + 400 + 18));
+
+    bool caught {false};
+    try {
+        view.transpose({0, 0, 1});
+    }
+    catch (std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+
+int main() {
+    std::cout << "Testing grid views...\n";
+    test_basic();
+
+    std::cout << "Testing subviews and strided views...\n";
+    test_subview_and_strides();
+
+    std::cout << "Testing slicing and transposing...\n";
+    test_slice_and_transpose();
+}
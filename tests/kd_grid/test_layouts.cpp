@@ -0,0 +1,112 @@
+
+#include "kd_grid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+
+/* Every cell gets its own slot in the buffer, whatever the layout. */
+template<typename Layout, int K>
+void check_mapping(const std::array<int, K*2>& bounds) {
+    typename Layout::template Mapping<K> mapping {bounds};
+
+    Util::KDGrid<int, K> all {bounds};
+    std::vector<std::size_t> offsets;
+    all.region().for_each([&](const std::array<int, K>& indices, int&) {
+        offsets.push_back(mapping.offset(indices));
+    });
+
+    std::sort(offsets.begin(), offsets.end());
+    assert(std::adjacent_find(offsets.begin(), offsets.end()) == offsets.end());
+    assert(offsets.back() < mapping.size());
+}
+
+template<typename Layout>
+void check_grid() {
+    Util::KDGrid<long, 3, Layout> grid {{-5, 6, 0, 2, 10, 40}, -1};
+    assert(grid.size() == 12 * 3 * 31);
+    assert((grid[{0, 0, 10}] == -1));
+
+    for (int i {-5}; i <= 6; i++) {
+        for (int j {0}; j <= 2; j++) {
+            for (int k {10}; k <= 40; k++) {
+                grid[{i, j, k}] = i * 10000 + j * 100 + k;
+            }
+        }
+    }
+
+    long sum {0};
+    grid.region({-1, 1, 20}, {1, 2, 21}).for_each([&sum](const std::array<int, 3>& indices, long& cell) {
+        assert(cell == indices[0] * 10000 + indices[1] * 100 + indices[2]);
+        sum += cell;
+    });
+    assert(sum == 3 * 2 * 2 * 0 + 3 * 2 * (20 + 21) + 3 * 2 * (100 + 200));
+
+    bool caught {false};
+    try {
+        grid[{7, 0, 10}] = 0;
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_mappings() {
+    check_mapping<Util::RowMajorLayout, 2>({-3, 3, 0, 10});
+    check_mapping<Util::MortonLayout, 2>({-3, 3, 0, 10});
+    check_mapping<Util::MortonLayout, 3>({0, 0, 0, 31, -7, 9});
+    check_mapping<Util::TiledLayout<4>, 2>({-3, 3, 0, 10});
+    check_mapping<Util::TiledLayout<3>, 3>({0, 0, 0, 31, -7, 9});
+}
+
+void test_morton_locality() {
+    // A 4x4x4 cube at an aligned corner is one contiguous block of 64.
+    Util::MortonLayout::Mapping<3> mapping {{0, 63, 0, 63, 0, 63}};
+    std::size_t lowest {mapping.offset({4, 8, 12})};
+    assert(lowest % 64 == 0);
+    for (int i {4}; i < 8; i++) {
+        for (int j {8}; j < 12; j++) {
+            for (int k {12}; k < 16; k++) {
+                assert(mapping.offset({i, j, k}) - lowest < 64);
+            }
+        }
+    }
+
+    // The last dimension holds the lowest bit.
+    assert((mapping.offset({0, 0, 1}) == 1 && mapping.offset({0, 1, 0}) == 2 && mapping.offset({1, 0, 0}) == 4));
+}
+
+void test_tiles() {
+    Util::TiledLayout<8>::Mapping<2> mapping {{0, 19, 0, 19}};
+    assert(mapping.size() == 24 * 24);
+    assert((mapping.offset({0, 7}) == 7 && mapping.offset({1, 0}) == 8 && mapping.offset({0, 8}) == 64));
+}
+
+void test_grids() {
+    check_grid<Util::RowMajorLayout>();
+    check_grid<Util::MortonLayout>();
+    check_grid<Util::TiledLayout<4>>();
+
+    // bool has no bit packing outside of row major, but still works.
+    Util::KDGrid<bool, 2, Util::MortonLayout> flags {{0, 9, 0, 9}};
+    flags[{3, 4}] = true;
+    assert((flags[{3, 4}] && !flags[{4, 3}]));
+}
+
+
+int main() {
+    std::cout << "Testing that layouts give every cell its own place...\n";
+    test_mappings();
+
+    std::cout << "Testing Morton order...\n";
+    test_morton_locality();
+
+    std::cout << "Testing tiles...\n";
+    test_tiles();
+
+    std::cout << "Testing grids with each layout...\n";
+    test_grids();
+}
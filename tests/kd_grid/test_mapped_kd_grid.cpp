@@ -0,0 +1,139 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+
+const std::string path {std::filesystem::temp_directory_path() / "test_mapped_kd_grid.tmp"};
+
+struct Terrain {
+    float height;
+    short cost;
+};
+
+void test_round_trip() {
+    Util::KDGrid<Terrain, 3> grid {{-3, 40, 0, 9, 5, 7}};
+    grid.region().for_each([](const std::array<int, 3>& indices, Terrain& cell) {
+        cell = {indices[0] * 0.5f, static_cast<short>(indices[1] * 10 + indices[2])};
+    });
+    Util::save_grid(grid, path);
+
+    const Util::MappedKDGrid<Terrain, 3> mapped {path};
+    assert(mapped.get_bounds() == grid.get_bounds());
+    assert(mapped.size() == grid.size());
+    assert(mapped.get_mode() == Util::MapMode::ReadOnly);
+    grid.region().for_each([&mapped](const std::array<int, 3>& indices, const Terrain& cell) {
+        assert(mapped[indices].height == cell.height);
+        assert(mapped.get_unchecked(indices).cost == cell.cost);
+    });
+
+    Util::KDGridView<const Terrain, 3> view {mapped.view()};
+    assert((view[{40, 9, 7}].cost == 97));
+    assert((view.slice(0, 2)[{3, 6}].height == 1.0f));
+
+    Util::MappedKDGrid<Terrain, 3> reopened {path};
+    static_assert(std::is_same_v<decltype(reopened.view()), Util::KDGridView<const Terrain, 3>>);
+    assert((reopened.view()[{40, 9, 7}].cost == 97));
+
+    Util::KDGrid<Terrain, 3> copy {mapped.to_grid()};
+    assert((copy[{-3, 0, 5}].height == -1.5f));
+
+    bool caught {false};
+    try {
+        mapped[{41, 0, 5}];
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_modes() {
+    Util::KDGrid<int, 2, Util::MortonLayout> grid {{0, 20, 0, 4}, 5};
+    grid[{20, 4}] = 9;
+    Util::save_grid(grid, path);
+
+    // Not const, but read only mappings only hand out const cells.
+    Util::MappedKDGrid<int, 2, Util::MortonLayout> read_only {path};
+    assert((read_only[{20, 4}] == 9 && read_only[{3, 2}] == 5));
+    static_assert(std::is_same_v<decltype(read_only[{0, 0}]), const int&>);
+    static_assert(std::is_same_v<decltype(read_only.get_unchecked({0, 0})), const int&>);
+
+    bool caught {false};
+    try {
+        read_only[{21, 0}];
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+
+    // Writes stay in this process; the file and other mappings never see them.
+    Util::MappedKDGrid<int, 2, Util::MortonLayout, Util::MapMode::CopyOnWrite> private_copy {path};
+    assert(private_copy.get_mode() == Util::MapMode::CopyOnWrite);
+    private_copy[{0, 0}] = 1;
+    private_copy[{20, 4}] += 1;
+    assert((private_copy[{0, 0}] == 1 && private_copy[{20, 4}] == 10));
+    assert((read_only[{0, 0}] == 5));
+    assert((Util::MappedKDGrid<int, 2, Util::MortonLayout> {path}[{20, 4}] == 9));
+
+    Util::save_grid(private_copy.to_grid(), path);
+    assert((Util::MappedKDGrid<int, 2, Util::MortonLayout> {path}[{20, 4}] == 10));
+}
+
+template<typename T, int K, typename Layout = Util::RowMajorLayout>
+bool refuses(const std::string& file) {
+    try {
+        Util::MappedKDGrid<T, K, Layout> {file};
+    }
+    catch (std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_mismatches() {
+    Util::save_grid(Util::KDGrid<int, 2> {{0, 3, 0, 3}, 1}, path);
+    assert((refuses<double, 2>(path)));
+    assert((refuses<int, 3>(path)));
+    assert((refuses<int, 2, Util::TiledLayout<2>>(path)));
+    assert((!refuses<int, 2>(path)));
+    assert((!refuses<float, 2>(path))); // Same size and alignment; the file cannot tell.
+
+    {
+        std::ofstream truncate {path, std::ios::binary | std::ios::trunc};
+        truncate << "KDGRID";
+    }
+    assert((refuses<int, 2>(path)));
+
+    bool caught {false};
+    try {
+        Util::MappedKDGrid<int, 2> {"no/such/file"};
+    }
+    catch (std::system_error&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+
+int main() {
+    std::cout << "Testing saving and mapping grids...\n";
+    test_round_trip();
+
+    std::cout << "Testing read only and copy on write mappings...\n";
+    test_modes();
+
+    std::cout << "Testing that mismatched files are refused...\n";
+    test_mismatches();
+
+    std::remove(path.c_str());
+}
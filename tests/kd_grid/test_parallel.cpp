@@ -0,0 +1,275 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+
+void test_map_reduce() {
+    Util::KDGrid<int, 3> grid {{-50, 49, 0, 99, 0, 19}};
+    for (int i {-50}; i <= 49; i++) {
+        for (int j {0}; j <= 99; j++) {
+            for (int k {0}; k <= 19; k++) {
+                grid[{i, j, k}] = i + j * k;
+            }
+        }
+    }
+
+    long expected_sum {0};
+    for (int i {-50}; i <= 49; i++) {
+        for (int j {0}; j <= 99; j++) {
+            for (int k {0}; k <= 19; k++) {
+                expected_sum += 2L * (i + j * k);
+            }
+        }
+    }
+
+    for (unsigned threads : {0u, 1u, 3u, 8u}) {
+        Util::KDGrid<long, 3> doubled {Util::Grid::map(grid, [](int cell) { return 2L * cell; }, threads)};
+        assert((doubled[{-50, 99, 19}] == 2L * (-50 + 99 * 19)));
+
+        long sum {Util::Grid::reduce(doubled, 0L, [](long a, long b) { return a + b; }, threads)};
+        assert(sum == expected_sum);
+
+        int max {Util::Grid::reduce(grid, -1000, [](int a, int b) { return std::max(a, b); }, threads)};
+        assert(max == 49 + 99 * 19);
+    }
+
+    // Bit packed results work too.
+    Util::KDGrid<bool, 3> odd {Util::Grid::map(grid, [](int cell) { return cell % 2 != 0; })};
+    assert((odd[{-49, 0, 0}] && !odd[{-50, 0, 0}] && odd[{0, 1, 1}]));
+
+    Util::Grid::map_in_place(grid, [](int cell) { return -cell; }, 4);
+    assert((grid[{10, 3, 4}] == -(10 + 12)));
+
+    Util::Grid::for_each(grid, [](const std::array<int, 3>& indices, int& cell) {
+        cell = indices[0];
+    }, 4);
+    assert((grid[{-7, 50, 19}] == -7));
+}
+
+void test_zip_with() {
+    Util::KDGrid<int, 2> a {{0, 299, 0, 299}, 3};
+    Util::KDGrid<std::string, 2> b {{0, 299, 0, 299}, "x"};
+    b[{150, 7}] = "yy";
+
+    Util::KDGrid<std::size_t, 2> zipped {Util::Grid::zip_with(a, b, [](int n, const std::string& s) {
+        return n * s.size();
+    }, 4)};
+    assert((zipped[{0, 0}] == 3 && zipped[{150, 7}] == 6));
+
+    Util::KDGrid<int, 2> mismatched {{0, 299, 0, 298}};
+    bool caught {false};
+    try {
+        Util::Grid::zip_with(a, mismatched, [](int x, int y) { return x + y; });
+    }
+    catch (std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+void test_stencil() {
+    // A box blur, compared against the obvious loops.
+    Util::KDGrid<double, 2> grid {{-100, 100, 0, 199}};
+    for (int i {-100}; i <= 100; i++) {
+        for (int j {0}; j <= 199; j++) {
+            grid[{i, j}] = (i * 31 + j * 17) % 23;
+        }
+    }
+
+    auto blur = [](const Util::Grid::Neighbourhood<double, 2>& n) {
+        double total {0};
+        for (int di {-1}; di <= 1; di++) {
+            for (int dj {-1}; dj <= 1; dj++) {
+                total += n[{di, dj}];
+            }
+        }
+        return total / 9;
+    };
+
+    for (unsigned threads : {1u, 5u}) {
+        Util::KDGrid<double, 2> blurred {Util::Grid::stencil(grid, 1, blur, 0.0, threads)};
+
+        for (int i {-100}; i <= 100; i++) {
+            for (int j {0}; j <= 199; j++) {
+                double total {0};
+                for (int di {-1}; di <= 1; di++) {
+                    for (int dj {-1}; dj <= 1; dj++) {
+                        if (grid.in_bounds({i + di, j + dj})) {
+                            total += grid[{i + di, j + dj}];
+                        }
+                    }
+                }
+                assert((blurred[{i, j}] == total / 9));
+            }
+        }
+    }
+}
+
+/* Reads past the declared radius are still bounds checked. */
+void test_stencil_radius() {
+    Util::KDGrid<int, 2> grid {{0, 9, 0, 9}};
+    for (int i {0}; i <= 9; i++) {
+        for (int j {0}; j <= 9; j++) {
+            grid[{i, j}] = i * 10 + j;
+        }
+    }
+
+    Util::KDGrid<int, 2> shifted {Util::Grid::stencil(grid, 0, [](const Util::Grid::Neighbourhood<int, 2>& n) {
+        return n[{3, -1}];
+    }, -1)};
+    for (int i {0}; i <= 9; i++) {
+        for (int j {0}; j <= 9; j++) {
+            assert((shifted[{i, j}] == (i + 3 <= 9 && j >= 1 ? grid[{i + 3, j - 1}] : -1)));
+        }
+    }
+
+    bool caught {false};
+    try {
+        Util::Grid::stencil(grid, -1, [](const Util::Grid::Neighbourhood<int, 2>& n) { return n[{0, 0}]; }, 0);
+    }
+    catch (std::invalid_argument&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+/* Bit packed inputs are read a word at a time, rather than as a region. */
+void test_bool_inputs() {
+    Util::KDGrid<bool, 2> alive {{-150, 149, 7, 306}};
+    for (int i {-150}; i <= 149; i++) {
+        for (int j {7}; j <= 306; j++) {
+            alive[{i, j}] = (i * 7 + j * 13) % 5 == 0;
+        }
+    }
+
+    auto live_neighbours {[&alive](int i, int j) {
+        int count {0};
+        for (int di {-1}; di <= 1; di++) {
+            for (int dj {-1}; dj <= 1; dj++) {
+                count += (di != 0 || dj != 0) && alive.in_bounds({i + di, j + dj}) && alive[{i + di, j + dj}];
+            }
+        }
+        return count;
+    }};
+
+    for (unsigned threads : {1u, 4u}) {
+        Util::KDGrid<int, 2> as_ints {Util::Grid::map(alive, [](bool cell) { return cell ? 2 : 1; }, threads)};
+        int total {Util::Grid::reduce(alive, 0, [](int a, int b) { return a + b; }, threads)};
+        assert(total == static_cast<int>(alive.count()));
+        assert(Util::Grid::reduce(as_ints, 0, std::plus {}, threads) == 300 * 300 + total);
+
+        Util::KDGrid<int, 2> zipped {Util::Grid::zip_with(as_ints, alive, [](int n, bool cell) {
+            return cell ? -n : n;
+        }, threads)};
+
+        // One step of Conway's game of life.
+        Util::KDGrid<bool, 2> next {Util::Grid::stencil(alive, 1, [](const Util::Grid::Neighbourhood<bool, 2>& cells) {
+            int count {-cells[{0, 0}]};
+            for (int di {-1}; di <= 1; di++) {
+                for (int dj {-1}; dj <= 1; dj++) {
+                    count += cells[{di, dj}];
+                }
+            }
+            return count == 3 || (count == 2 && cells[{0, 0}]);
+        }, false, threads)};
+
+        for (int i {-150}; i <= 149; i++) {
+            for (int j {7}; j <= 306; j++) {
+                const bool cell {alive[{i, j}]};
+                assert((as_ints[{i, j}] == (cell ? 2 : 1)));
+                assert((zipped[{i, j}] == (cell ? -2 : 1)));
+                int count {live_neighbours(i, j)};
+                assert((next[{i, j}] == (count == 3 || (count == 2 && cell))));
+            }
+        }
+    }
+
+    Util::KDGrid<bool, 2> copy {alive};
+    Util::Grid::map_in_place(copy, [](bool cell) { return !cell; }, 4);
+    Util::Grid::for_each(copy, [](const std::array<int, 2>& indices, auto& cell) {
+        if (indices[1] == 7) {
+            cell.flip();
+        }
+    }, 4);
+    for (int i {-150}; i <= 149; i++) {
+        for (int j {7}; j <= 306; j++) {
+            assert((copy[{i, j}] == (alive[{i, j}] == (j == 7))));
+        }
+    }
+
+    // Slabs of a one dimensional grid start partway through words.
+    Util::KDGrid<bool, 1> line {{-40000, 39999}};
+    for (int i {-40000}; i < 40000; i += 7) {
+        line[{i}] = true;
+    }
+    assert(Util::Grid::reduce(line, 0, std::plus {}, 3) == static_cast<int>(line.count()));
+}
+
+/* Threads come from one pool, kept between calls, and calls may nest. */
+void test_thread_reuse() {
+    Util::KDGrid<int, 2> grid {{0, 255, 0, 255}, 1};
+    Util::KDGrid<int, 2> inner {{0, 255, 0, 255}, 2};
+
+    std::mutex lock;
+    std::set<std::thread::id> seen {};
+    for (int round {0}; round < 50; round++) {
+        Util::Grid::for_each(grid, [&](const std::array<int, 2>& indices, int& cell) {
+            if (indices[1] == 0) {
+                std::lock_guard<std::mutex> held {lock};
+                seen.insert(std::this_thread::get_id());
+            }
+            if (round == 0 && indices == std::array {0, 0}) {
+                cell = Util::Grid::reduce(inner, 0, std::plus {}, 4);
+            }
+        }, 4);
+    }
+    assert((grid[{0, 0}] == 2 * 256 * 256));
+    assert(seen.size() <= 8); // The caller and the pool, which earlier tests grew to 7.
+}
+
+void test_exceptions() {
+    Util::KDGrid<int, 2> grid {{0, 999, 0, 99}};
+    grid[{777, 5}] = 1;
+
+    bool caught {false};
+    try {
+        Util::Grid::map(grid, [](int cell) {
+            if (cell == 1) {
+                throw std::runtime_error("found it");
+            }
+            return cell;
+        }, 4);
+    }
+    catch (std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+
+int main() {
+    std::cout << "Testing parallel map and reduce...\n";
+    test_map_reduce();
+
+    std::cout << "Testing parallel zip_with...\n";
+    test_zip_with();
+
+    std::cout << "Testing parallel stencils...\n";
+    test_stencil();
+    test_stencil_radius();
+
+    std::cout << "Testing parallel operations on bool grids...\n";
+    test_bool_inputs();
+
+    std::cout << "Testing that threads are reused...\n";
+    test_thread_reuse();
+
+    std::cout << "Testing that exceptions escape worker threads...\n";
+    test_exceptions();
+}
@@ -0,0 +1,132 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <climits>
+#include <iostream>
+#include <random>
+
+
+Util::KDGrid<int, 3> random_grid(std::mt19937& g) {
+    Util::KDGrid<int, 3> grid {{-4, 5, 0, 6, 10, 17}};
+    grid.region().for_each([&g](const std::array<int, 3>&, int& cell) {
+        cell = static_cast<int>(g() % 201) - 100;
+    });
+    return grid;
+}
+
+long brute_force_sum(const Util::KDGrid<int, 3>& grid, const std::array<int, 3>& min, const std::array<int, 3>& max) {
+    long total {0};
+    grid.region(min, max).for_each([&total](const std::array<int, 3>&, const int& cell) {
+        total += cell;
+    });
+    return total;
+}
+
+std::pair<std::array<int, 3>, std::array<int, 3>> random_box(std::mt19937& g, const std::array<int, 6>& bounds) {
+    std::array<int, 3> min, max;
+    for (int k {0}; k < 3; k++) {
+        int extent {bounds[2 * k+1] - bounds[2 * k] + 1};
+        int a {bounds[2 * k] + static_cast<int>(g() % extent)};
+        int b {bounds[2 * k] + static_cast<int>(g() % extent)};
+        min[k] = std::min(a, b);
+        max[k] = std::max(a, b);
+    }
+    return {min, max};
+}
+
+void test_summed_area_table() {
+    std::mt19937 g(3);
+    Util::KDGrid<int, 3> grid {random_grid(g)};
+    Util::SummedAreaTable<int, 3, long> table {grid};
+
+    assert(table.total() == brute_force_sum(grid, {-4, 0, 10}, {5, 6, 17}));
+    assert((table.prefix({0, 0, 10}) == brute_force_sum(grid, {-4, 0, 10}, {0, 0, 10})));
+
+    for (int trial {0}; trial < 500; trial++) {
+        auto [min, max] = random_box(g, grid.get_bounds());
+        assert(table.sum(min, max) == brute_force_sum(grid, min, max));
+    }
+
+    // Bulk update, then rebuild.
+    grid.region({0, 0, 10}, {5, 6, 17}).for_each([](const std::array<int, 3>&, int& cell) {
+        cell = 1000;
+    });
+    table.rebuild(grid);
+    for (int trial {0}; trial < 100; trial++) {
+        auto [min, max] = random_box(g, grid.get_bounds());
+        assert(table.sum(min, max) == brute_force_sum(grid, min, max));
+    }
+
+    // One dimension works too.
+    Util::KDGrid<int, 1> line {{-3, 3}, 2};
+    Util::SummedAreaTable<int, 1> line_table {line};
+    assert((line_table.sum({-3}, {3}) == 14 && line_table.sum({0}, {0}) == 2));
+
+    int errors_caught {0};
+    try {
+        table.sum({-5, 0, 10}, {0, 0, 10});
+    }
+    catch (std::out_of_range&) {
+        errors_caught++;
+    }
+    try {
+        table.rebuild(Util::KDGrid<int, 3> {{0, 1, 0, 1, 0, 1}});
+    }
+    catch (std::invalid_argument&) {
+        errors_caught++;
+    }
+    try {
+        Util::SummedAreaTable<int, 1> {Util::KDGrid<int, 1> {{INT_MIN, INT_MIN + 3}}};
+    }
+    catch (std::invalid_argument&) {
+        errors_caught++;
+    }
+    assert(errors_caught == 3);
+}
+
+void test_fenwick_tree() {
+    std::mt19937 g(4);
+    Util::KDGrid<int, 3> grid {random_grid(g)};
+    Util::FenwickTree<long, 3> tree {Util::KDGrid<long, 3> {grid.get_bounds()}};
+    Util::FenwickTree<int, 3> built {grid};
+
+    grid.region().for_each([&tree](const std::array<int, 3>& indices, const int& cell) {
+        tree.add(indices, cell);
+    });
+
+    for (int trial {0}; trial < 300; trial++) {
+        auto [min, max] = random_box(g, grid.get_bounds());
+        assert(tree.sum(min, max) == brute_force_sum(grid, min, max));
+        assert(built.sum(min, max) == brute_force_sum(grid, min, max));
+
+        // Point updates as we go.
+        std::array<int, 3> point {random_box(g, grid.get_bounds()).first};
+        int delta {static_cast<int>(g() % 21) - 10};
+        grid[point] += delta;
+        tree.add(point, delta);
+        built.add(point, delta);
+        assert(tree.get(point) == grid[point]);
+    }
+
+    Util::FenwickTree<int, 2> empty {{0, 3, -3, 0}};
+    assert((empty.sum({0, -3}, {3, 0}) == 0));
+    empty.add({3, -3}, 5);
+    assert((empty.prefix({3, -3}) == 5 && empty.prefix({2, 0}) == 0));
+
+    // Boxes starting at INT_MIN have nothing below them to subtract.
+    Util::FenwickTree<int, 2> low {{INT_MIN, INT_MIN + 3, 0, 3}};
+    low.add({INT_MIN, 0}, 4);
+    low.add({INT_MIN + 1, 3}, 6);
+    assert((low.sum({INT_MIN, 0}, {INT_MIN + 3, 3}) == 10 && low.get({INT_MIN, 0}) == 4));
+    assert((low.sum({INT_MIN + 1, 1}, {INT_MIN + 2, 3}) == 6));
+}
+
+
+int main() {
+    std::cout << "Testing summed area tables...\n";
+    test_summed_area_table();
+
+    std::cout << "Testing Fenwick trees...\n";
+    test_fenwick_tree();
+}
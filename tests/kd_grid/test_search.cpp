@@ -0,0 +1,147 @@
+
+#include "kd_grid.h"
+
+#include <array>
+#include <cassert>
+#include <deque>
+#include <iostream>
+#include <vector>
+
+
+/* A maze of walls (true) with gaps, big enough that the frontier goes parallel. */
+Util::KDGrid<bool, 2> make_maze(int side) {
+    Util::KDGrid<bool, 2> walls {{0, side - 1, 0, side - 1}, false};
+    for (int i {4}; i < side; i += 8) {
+        for (int j {0}; j < side; j++) {
+            walls[{i, j}] = (j * 7 + i) % 53 != 0;
+        }
+    }
+    return walls;
+}
+
+/* The obvious single threaded search, to check against. */
+Util::KDGrid<int, 2> serial_bfs(const Util::KDGrid<bool, 2>& walls, const std::vector<std::array<int, 2>>& sources) {
+    Util::KDGrid<int, 2> distances {walls.get_bounds(), Util::Grid::unreachable};
+    std::deque<std::array<int, 2>> queue;
+    for (const std::array<int, 2>& source : sources) {
+        if (distances[source] == Util::Grid::unreachable) {
+            distances[source] = 0;
+            queue.push_back(source);
+        }
+    }
+
+    while (!queue.empty()) {
+        std::array<int, 2> cell {queue.front()};
+        queue.pop_front();
+        for (std::array<int, 2> step : {std::array {-1, 0}, {1, 0}, {0, -1}, {0, 1}}) {
+            std::array<int, 2> next {cell[0] + step[0], cell[1] + step[1]};
+            if (walls.in_bounds(next) && !walls[next] && distances[next] == Util::Grid::unreachable) {
+                distances[next] = distances[cell] + 1;
+                queue.push_back(next);
+            }
+        }
+    }
+    return distances;
+}
+
+void test_bfs() {
+    Util::KDGrid<bool, 2> walls {make_maze(600)};
+    std::vector<std::array<int, 2>> sources {{0, 0}, {599, 599}, {300, 10}, {0, 0}};
+    Util::KDGrid<int, 2> expected {serial_bfs(walls, sources)};
+
+    for (unsigned threads : {0u, 1u, 3u, 8u}) {
+        Util::KDGrid<int, 2> distances {Util::Grid::bfs(walls, sources, [](bool wall) { return !wall; },
+            Util::Grid::Connectivity::Faces, threads)};
+        for (int i {0}; i < 600; i++) {
+            for (int j {0}; j < 600; j++) {
+                assert((distances[{i, j}] == expected[{i, j}]));
+            }
+        }
+    }
+
+    // A whole face of sources, so each frontier is wide enough to be split up.
+    Util::KDGrid<short, 3> slab {{0, 29, 0, 149, 0, 149}, 0};
+    std::vector<std::array<int, 3>> face;
+    for (int j {0}; j <= 149; j++) {
+        for (int k {0}; k <= 149; k++) {
+            face.push_back({0, j, k});
+        }
+    }
+    slab[{10, 75, 75}] = 1;
+    Util::KDGrid<int, 3> depth {Util::Grid::bfs(slab, face, [](short cell) { return cell == 0; },
+        Util::Grid::Connectivity::Faces, 4)};
+    assert((depth[{29, 3, 149}] == 29));
+    assert((depth[{10, 75, 75}] == Util::Grid::unreachable));
+    assert((depth[{11, 75, 75}] == 12));
+
+    assert((expected[{0, 0}] == 0));
+    assert((expected[{1, 1}] == 2));
+    assert((expected[{4, 1}] == Util::Grid::unreachable)); // A wall.
+}
+
+void test_diagonals() {
+    Util::KDGrid<int, 3> grid {{0, 9, 0, 9, 0, 9}, 0};
+    Util::KDGrid<int, 3> faces {Util::Grid::bfs(grid, {{0, 0, 0}}, [](int) { return true; })};
+    Util::KDGrid<int, 3> all {Util::Grid::bfs(grid, {{0, 0, 0}}, [](int) { return true; }, Util::Grid::Connectivity::All)};
+
+    assert((faces[{9, 9, 9}] == 27));
+    assert((all[{9, 9, 9}] == 9));
+    assert((all[{3, 7, 5}] == 7));
+
+    // A diagonal wall stops face moves but not corner moves.
+    Util::KDGrid<char, 2> board {{0, 3, 0, 3}, '.'};
+    for (int i {0}; i <= 3; i++) {
+        board[{i, 3 - i}] = '#';
+    }
+    auto open = [](char cell) { return cell == '.'; };
+    Util::KDGrid<bool, 2> blocked {Util::Grid::flood_fill(board, {{0, 0}}, open)};
+    Util::KDGrid<bool, 2> leaked {Util::Grid::flood_fill(board, {{0, 0}}, open, Util::Grid::Connectivity::All)};
+    assert(blocked.count() == 6);
+    assert((!blocked[{3, 3}]));
+    assert(leaked.count() == 12);
+    assert((leaked[{3, 3}]));
+}
+
+void test_flood_fill() {
+    // Two rooms split by a wall along the first dimension, one door.
+    Util::KDGrid<int, 3> rooms {{-20, 20, 0, 39, 0, 39}, 0};
+    for (int j {0}; j <= 39; j++) {
+        for (int k {0}; k <= 39; k++) {
+            rooms[{0, j, k}] = 1;
+        }
+    }
+
+    auto open = [](int cell) { return cell == 0; };
+    Util::KDGrid<bool, 3> left {Util::Grid::flood_fill(rooms, {{-5, 5, 5}}, open)};
+    assert(left.count() == 20 * 40 * 40);
+    assert((!left[{5, 5, 5}]));
+
+    rooms[{0, 17, 3}] = 0;
+    Util::KDGrid<bool, 3> both {Util::Grid::flood_fill(rooms, {{-5, 5, 5}}, open, Util::Grid::Connectivity::Faces, 4)};
+    assert(both.count() == 41 * 40 * 40 - 40 * 40 + 1);
+
+    // Seeds are filled even when they are walls.
+    Util::KDGrid<bool, 3> wall {Util::Grid::flood_fill(rooms, {{0, 0, 0}}, [](int) { return false; })};
+    assert(wall.count() == 1);
+
+    bool caught {false};
+    try {
+        Util::Grid::flood_fill(rooms, {{21, 0, 0}}, open);
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+
+int main() {
+    std::cout << "Testing breadth first search against a serial search...\n";
+    test_bfs();
+
+    std::cout << "Testing connectivity...\n";
+    test_diagonals();
+
+    std::cout << "Testing flood fill...\n";
+    test_flood_fill();
+}
@@ -0,0 +1,98 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <climits>
+#include <iostream>
+
+
+void test_basic() {
+    Util::SparseKDGrid<std::string, 5, 4> string_grid {{-10, 10, -10, 10, -10, 10, -10, 10, -10, 10}, "Hello World"};
+
+    assert((string_grid.get({3, -2, 10, 0, -10}) == "Hello World"));
+    assert(string_grid.chunk_count() == 0); // Reads do not allocate.
+
+    for (int i {-10}; i <= 10; i++) {
+        string_grid[{i, 0, 0, 0, 0}] = "!!!";
+    }
+    assert(string_grid.chunk_count() == 6); // 21 cells along one axis, in chunks of 4.
+
+    for (int i {-10}; i <= 10; i++) {
+        assert((string_grid.get({i, 0, 0, 0, 0}) == "!!!"));
+        assert((string_grid.get({i, 0, 0, 0, 1}) == "Hello World"));
+    }
+    assert((string_grid.is_resident({-10, 0, 0, 0, 1}) && !string_grid.is_resident({-10, 10, 0, 0, 0})));
+
+    int resident {0};
+    string_grid.for_each_resident([&resident](const std::array<int, 5>& indices, std::string& cell) {
+        assert((cell == "!!!") == (indices[1] == 0 && indices[2] == 0 && indices[3] == 0 && indices[4] == 0));
+        resident++;
+    });
+    assert(resident == 21 * 4 * 4 * 4 * 4); // The last chunk has 3 cells sticking out of the grid.
+
+    string_grid.clear();
+    assert((string_grid.chunk_count() == 0 && string_grid.get({-10, 0, 0, 0, 0}) == "Hello World"));
+}
+
+void test_huge_domain() {
+    // Dense, this would be 8e18 bytes.
+    Util::SparseKDGrid<char, 3> occupancy {{-1000000, 1000000, -1000000, 1000000, -1000000, 1000000}};
+    std::size_t empty_bytes {occupancy.resident_bytes()};
+
+    for (int i {0}; i < 1000; i++) {
+        occupancy[{i * 1999 - 1000000, -i * 997, i * 13}] = 1;
+    }
+    assert(occupancy.chunk_count() == 1000);
+    assert(occupancy.resident_bytes() > empty_bytes + 1000 * 512);
+    assert(occupancy.resident_bytes() < 1000 * 1024);
+
+    for (int i {0}; i < 1000; i++) {
+        assert((occupancy.get({i * 1999 - 1000000, -i * 997, i * 13}) == 1));
+        assert((occupancy.get({i * 1999 - 1000000 + 1, -i * 997, i * 13}) == 0));
+    }
+
+    int errors_caught {0};
+    try {
+        occupancy[{1000001, 0, 0}] = 1;
+    }
+    catch (std::out_of_range&) {
+        errors_caught++;
+    }
+    try {
+        occupancy.get({0, 0, -1000001});
+    }
+    catch (std::out_of_range&) {
+        errors_caught++;
+    }
+    assert(errors_caught == 2);
+}
+
+/* Chunks on the upper edge of a grid reaching INT_MAX poke out past it. */
+void test_full_int_range() {
+    Util::SparseKDGrid<int, 2> grid {{INT_MIN + 3, INT_MAX, INT_MIN + 3, INT_MAX}};
+    grid[{INT_MIN + 3, INT_MIN + 3}] = 1;
+    grid[{INT_MAX, INT_MAX}] = 2;
+    grid[{INT_MAX, 0}] = 3;
+
+    int resident {0};
+    int total {0};
+    grid.for_each_resident([&](const std::array<int, 2>& indices, int& cell) {
+        assert(grid.in_bounds(indices));
+        resident++;
+        total += cell;
+    });
+    assert(resident == 64 + 5 * 5 + 5 * 8);
+    assert(total == 6);
+}
+
+
+int main() {
+    std::cout << "Testing sparse grids...\n";
+    test_basic();
+
+    std::cout << "Testing a huge, mostly empty domain...\n";
+    test_huge_domain();
+
+    std::cout << "Testing a grid spanning every int...\n";
+    test_full_int_range();
+}
@@ -0,0 +1,72 @@
+
+#include "kd_grid.h"
+
+#include <cassert>
+#include <iostream>
+
+
+constexpr int checkerboard_sum() {
+    Util::StaticKDGrid<int, -2, 2, 0, 3> grid {1};
+
+    grid.for_each([](const std::array<int, 2>& indices, int& cell) {
+        cell = (indices[0] + indices[1]) % 2 == 0 ? 2 : 0;
+    });
+    grid[{-2, 3}] = 10;
+
+    int sum {0};
+    grid.for_each([&sum](const std::array<int, 2>&, const int& cell) {
+        sum += cell;
+    });
+    return sum;
+}
+
+// Everything can happen at compile time.
+static_assert(checkerboard_sum() == 30);
+static_assert(Util::StaticKDGrid<char, 0, 63, 0, 63, 0, 63>::size() == 64 * 64 * 64);
+static_assert(Util::StaticKDGrid<char, 0, 9>::in_bounds({9}) && !Util::StaticKDGrid<char, 0, 9>::in_bounds({10}));
+
+void test_basic() {
+    // Large chunks should not live on the stack.
+    static Util::StaticKDGrid<int, 0, 63, 0, 63, 0, 63> chunk {};
+
+    assert((chunk[{5, 6, 7}] == 0));
+    for (int i {0}; i < 64; i++) {
+        for (int j {0}; j < 64; j++) {
+            for (int k {0}; k < 64; k++) {
+                chunk.get_unchecked({i, j, k}) = i * 4096 + j * 64 + k;
+            }
+        }
+    }
+
+    for (int i {0}; i < 64; i++) {
+        assert((chunk[{i, i, i}] == i * 4096 + i * 64 + i));
+    }
+
+    int last {-1};
+    chunk.for_each([&last](const std::array<int, 3>& indices, int& cell) {
+        assert(cell == last + 1); // Memory order is row major.
+        assert(cell == indices[0] * 4096 + indices[1] * 64 + indices[2]);
+        last = cell;
+    });
+    assert(last == 64 * 64 * 64 - 1);
+
+    Util::StaticKDGrid<std::string, 1, 3, -1, 1> strings {"Hello World"};
+    assert((strings[{2, 0}] == "Hello World"));
+    strings.fill("!!!");
+    assert((strings[{3, -1}] == "!!!"));
+
+    bool caught {false};
+    try {
+        strings[{0, 0}] = "?";
+    }
+    catch (std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught);
+}
+
+
+int main() {
+    std::cout << "Testing static grids...\n";
+    test_basic();
+}
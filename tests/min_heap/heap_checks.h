@@ -0,0 +1,117 @@
+/*
+ * tests/min_heap/heap_checks.h
+ *
+ * Checks shared by the tests of heaps with MinHeap's interface, which compare
+ * them against MinHeap itself.
+ */
+#ifndef jackcasey067_TESTS_MIN_HEAP_HEAP_CHECKS_H
+#define jackcasey067_TESTS_MIN_HEAP_HEAP_CHECKS_H
+
+#include "min_heap.h"
+
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/* Edge weights for a width by width grid, each below max_weight. */
+inline std::vector<int> random_weights(int width, int max_weight) {
+    std::mt19937 g(5);
+    std::vector<int> weights (width * width);
+    for (int& weight : weights) {
+        weight = g() % max_weight;
+    }
+    return weights;
+}
+
+/* Shortest distances from vertex 0 in a width by width grid, where entering a
+ * vertex costs its weight. */
+template<typename Heap>
+std::vector<long> dijkstra(int width, const std::vector<int>& weights, Heap& heap) {
+    std::vector<long> distance (width * width, -1);
+    heap.insert(0, 0);
+
+    while (!heap.is_empty()) {
+        long d {heap.get_priority(heap.peak_min())};
+        int v {heap.pop_min()};
+        distance[v] = d;
+
+        int neighbours[] {v - width, v + width, v % width == 0 ? -1 : v - 1, v % width == width - 1 ? -1 : v + 1};
+        for (int u : neighbours) {
+            if (u < 0 || u >= width * width || distance[u] != -1) {
+                continue;
+            }
+            long through_v {d + weights[u]};
+            if (!heap.contains(u)) {
+                heap.insert(u, through_v);
+            }
+            else if (through_v < heap.get_priority(u)) {
+                heap.update_priority(u, through_v);
+            }
+        }
+    }
+    return distance;
+}
+
+/* What the search should find, from the search with MinHeap. */
+inline std::vector<long> expected_distances(int width, const std::vector<int>& weights) {
+    Util::MinHeap<int, long> heap {};
+    return dijkstra(width, weights, heap);
+}
+
+/* A random monotone workload, starting from low, with every priority at most
+ * spread above the last popped minimum. Checked step by step against MinHeap,
+ * then popped until empty. */
+template<typename Heap>
+void check_against_min_heap(Heap& heap, int low, int spread, unsigned seed) {
+    std::mt19937 g(seed);
+    Util::MinHeap<std::string, int> expected {};
+
+    auto check_pop = [&heap, &expected]() {
+        std::string peaked {heap.peak_min()};
+        int p {heap.get_priority(peaked)};
+        assert(p == expected.get_priority(expected.peak_min()));
+        assert(heap.pop_min() == peaked);
+        expected.remove(peaked);
+        return p;
+    };
+
+    int last {low};
+    int next_name {0};
+    for (int step {0}; step < 20000; step++) {
+        int choice = g() % 10;
+        if (choice < 5 || heap.is_empty()) {
+            std::string name {std::to_string(next_name++) + "#"};
+            int p = last + g() % (spread + 1);
+            expected.insert(name, p);
+            heap.insert(name, p);
+        }
+        else if (choice < 8) {
+            last = check_pop();
+        }
+        else {
+            std::string name {std::to_string(g() % next_name) + "#"};
+            if (heap.contains(name)) {
+                int p = last + g() % (spread + 1);
+                if (choice == 8) {
+                    heap.update_priority(name, p);
+                    expected.update_priority(name, p);
+                }
+                else {
+                    heap.remove(name);
+                    expected.remove(name);
+                }
+            }
+            assert(heap.contains(name) == expected.contains(name));
+        }
+        assert(heap.size() == expected.size());
+    }
+
+    while (!heap.is_empty()) {
+        check_pop();
+    }
+    assert(expected.is_empty());
+}
+
+#endif /* jackcasey067_TESTS_MIN_HEAP_HEAP_CHECKS_H */
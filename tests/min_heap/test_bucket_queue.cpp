@@ -0,0 +1,85 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+void test_dijkstra() {
+    const int width {150};
+    std::vector<int> weights {random_weights(width, 100)};
+
+    Util::BucketQueue<int, long> buckets (99);
+    std::vector<long> expected {expected_distances(width, weights)};
+    assert(dijkstra(width, weights, buckets) == expected);
+
+    // Reusable after emptying.
+    assert(dijkstra(width, weights, buckets) == expected);
+}
+
+/* Priorities stay within the window. */
+void test_against_min_heap() {
+    const int spread {300};
+    Util::BucketQueue<std::string, int> buckets (spread);
+    assert(buckets.get_spread() == spread);
+    check_against_min_heap(buckets, 0, spread, 11);
+}
+
+void test_exceptions() {
+    int errors_caught {0};
+    auto expect_error = [&errors_caught](auto action) {
+        try {
+            action();
+        }
+        catch (Util::MinHeapException&) {
+            errors_caught++;
+        }
+    };
+
+    expect_error([]() { Util::BucketQueue<int> bad (-1); });
+
+    Util::BucketQueue<int> queue (10);
+    expect_error([&queue]() { queue.pop_min(); });
+    expect_error([&queue]() { queue.peak_min(); });
+    expect_error([&queue]() { queue.update_priority(2, 0); });
+    expect_error([&queue]() { queue.remove(2); });
+    queue.insert(1, 3);
+    queue.insert(2, 10);
+    queue.insert(3, 5);
+    expect_error([&queue]() { queue.insert(2, 4); });
+    expect_error([&queue]() { queue.insert(4, 11); }); // Past 0 + 10, before any pop.
+    assert(queue.pop_min() == 1);
+    expect_error([&queue]() { queue.insert(4, 2); });
+    expect_error([&queue]() { queue.update_priority(2, 2); });
+    expect_error([&queue]() { queue.update_priority(2, 14); });
+    assert(errors_caught == 10);
+    assert(queue.get_priority(2) == 10 && !queue.contains(4));
+    queue.insert(4, 13);
+
+    // An empty queue slides its window to whatever comes next.
+    queue.remove(3);
+    queue.remove(4);
+    queue.update_priority(2, 50);
+    assert(queue.pop_min() == 2);
+    queue.insert(5, 100);
+    queue.insert(6, 90);
+    assert(queue.pop_min() == 6 && queue.pop_min() == 5);
+    queue.insert(7, -5);
+    queue.insert(8, -1);
+    assert(queue.pop_min() == 7 && queue.pop_min() == 8);
+}
+
+
+int main() {
+    std::cout << "Testing shortest paths against MinHeap...\n";
+    test_dijkstra();
+
+    std::cout << "Testing a random workload against MinHeap...\n";
+    test_against_min_heap();
+
+    std::cout << "Testing that misuse throws useful exceptions...\n";
+    test_exceptions();
+}
@@ -0,0 +1,83 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+
+void test_dijkstra() {
+    const int width {150};
+    std::vector<int> weights {random_weights(width, 100)};
+
+    Util::IndexedMinHeap<long> indexed (width * width);
+    Util::IndexedMinHeap<long, 4> wide (width * width);
+    std::vector<long> expected {expected_distances(width, weights)};
+    assert(dijkstra(width, weights, indexed) == expected);
+    assert(dijkstra(width, weights, wide) == expected);
+
+    // Reusable after emptying, whether by popping or by clear().
+    assert(dijkstra(width, weights, indexed) == expected);
+    for (int i {0}; i < 100; i++) {
+        indexed.insert(i * 7, -i);
+    }
+    indexed.clear();
+    assert(indexed.is_empty() && !indexed.contains(7));
+    assert(dijkstra(width, weights, indexed) == expected);
+}
+
+void test_insert_or_decrease() {
+    Util::IndexedMinHeap<int> heap (10);
+    assert(heap.get_capacity() == 10);
+    assert(heap.insert_or_decrease(3, 30));
+    assert(heap.insert_or_decrease(4, 40));
+    assert(!heap.insert_or_decrease(3, 35));
+    assert(heap.insert_or_decrease(4, 20));
+    assert(heap.get_priority(4) == 20 && heap.get_priority(3) == 30);
+
+    heap.insert(9, 25);
+    heap.remove(4);
+    assert(heap.size() == 2);
+    assert(heap.pop_min() == 9);
+    assert(heap.pop_min() == 3);
+    assert(heap.is_empty());
+}
+
+void test_exceptions() {
+    Util::IndexedMinHeap<int> heap (5);
+
+    int errors_caught {0};
+    auto expect_error = [&errors_caught](auto action) {
+        try {
+            action();
+        }
+        catch (Util::MinHeapException&) {
+            errors_caught++;
+        }
+    };
+
+    expect_error([&heap]() { heap.pop_min(); });
+    expect_error([&heap]() { heap.peak_min(); });
+    expect_error([&heap]() { heap.insert(5, 0); });
+    expect_error([&heap]() { heap.insert(-1, 0); });
+    expect_error([&heap]() { heap.update_priority(2, 0); });
+    expect_error([&heap]() { heap.remove(2); });
+    heap.insert(2, 0);
+    expect_error([&heap]() { heap.insert(2, 1); });
+    assert(errors_caught == 7);
+
+    assert(!heap.contains(5) && !heap.contains(-1) && heap.contains(2));
+}
+
+
+int main() {
+    std::cout << "Testing shortest paths against MinHeap...\n";
+    test_dijkstra();
+
+    std::cout << "Testing insert_or_decrease...\n";
+    test_insert_or_decrease();
+
+    std::cout << "Testing that bad keys throw useful exceptions...\n";
+    test_exceptions();
+}
@@ -0,0 +1,156 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/* Shortest distances from vertex 0 in a width by width grid of random edge
+ * weights, by lazy deletion: a vertex is pushed again whenever its distance
+ * improves, and older entries go stale. */
+std::vector<long> lazy_dijkstra(int width, const std::vector<int>& weights) {
+    std::vector<long> distance (width * width, -1);
+    std::vector<long> best (width * width, -1);
+
+    Util::LazyMinHeap<int, long, 4> heap {[&distance, &best](const int& v, const long& d) {
+        return distance[v] != -1 || d != best[v];
+    }};
+    heap.insert(0, 0);
+    best[0] = 0;
+
+    while (!heap.is_empty()) {
+        auto [v, d] {heap.pop_min_with_priority()};
+        distance[v] = d;
+
+        int neighbours[] {v - width, v + width, v % width == 0 ? -1 : v - 1, v % width == width - 1 ? -1 : v + 1};
+        for (int u : neighbours) {
+            if (u < 0 || u >= width * width || distance[u] != -1) {
+                continue;
+            }
+            long through_v {d + weights[u]};
+            if (best[u] == -1 || through_v < best[u]) {
+                best[u] = through_v;
+                heap.insert(u, through_v);
+            }
+        }
+    }
+    return distance;
+}
+
+void test_dijkstra() {
+    const int width {150};
+    std::vector<int> weights {random_weights(width, 100)};
+    std::vector<long> expected {expected_distances(width, weights)};
+
+    assert(lazy_dijkstra(width, weights) == expected);
+}
+
+/* With no staleness check, it is a plain heap that allows duplicates. */
+void test_duplicates() {
+    std::mt19937 g(3);
+    Util::LazyMinHeap<std::string> heap {};
+    std::vector<int> priorities {};
+    for (int i {0}; i < 1000; i++) {
+        priorities.push_back(g() % 100);
+        heap.insert(std::to_string(priorities.back() % 10), priorities.back());
+    }
+    assert(heap.size() == 1000);
+    heap.compact(); // Nothing is stale.
+    assert(heap.size() == 1000);
+
+    std::sort(priorities.begin(), priorities.end());
+    for (int p : priorities) {
+        assert(heap.peak_priority() == p);
+        assert(heap.pop_min() == std::to_string(p % 10));
+    }
+    assert(heap.is_empty());
+}
+
+void test_staleness() {
+    std::vector<bool> cancelled (100, false);
+    Util::LazyMinHeap<int, int, 3> heap {[&cancelled](const int& v, const int&) {
+        return cancelled[v];
+    }};
+    for (int i {0}; i < 100; i++) {
+        heap.insert(i, 100 - i);
+    }
+
+    // Cancelling everything above 9 leaves the heap looking like it holds 0 to 9.
+    for (int i {10}; i < 100; i++) {
+        cancelled[i] = true;
+    }
+    assert(heap.size() == 100);
+    assert(heap.peak_min() == 9 && heap.peak_priority() == 91);
+    heap.compact();
+    assert(heap.size() == 10);
+
+    for (int i {9}; i >= 0; i--) {
+        cancelled[i - i % 2] = true; // Evens go stale while the heap is in use.
+        if (i % 2 == 1) {
+            assert(heap.pop_min() == i);
+        }
+    }
+    assert(heap.is_empty() && heap.size() == 0);
+}
+
+void test_move_only() {
+    Util::LazyMinHeap<std::unique_ptr<int>> heap {[](const std::unique_ptr<int>& v, const int&) {
+        return *v % 3 == 0;
+    }};
+    for (int i {0}; i < 100; i++) {
+        heap.insert(std::make_unique<int>(i), (i * 37) % 100);
+    }
+    heap.compact();
+    int previous {-1};
+    while (!heap.is_empty()) {
+        auto [value, p] {heap.pop_min_with_priority()};
+        assert(*value % 3 != 0 && p > previous);
+        previous = p;
+    }
+}
+
+void test_exceptions() {
+    Util::LazyMinHeap<int> heap {[](const int& v, const int&) { return v < 0; }};
+
+    int errors_caught {0};
+    auto expect_error = [&errors_caught](auto action) {
+        try {
+            action();
+        }
+        catch (Util::MinHeapException&) {
+            errors_caught++;
+        }
+    };
+
+    expect_error([&heap]() { heap.pop_min(); });
+    expect_error([&heap]() { heap.peak_min(); });
+    heap.insert(-1, 0);
+    heap.insert(-2, 1);
+    expect_error([&heap]() { heap.pop_min_with_priority(); }); // Only stale entries.
+    expect_error([&heap]() { heap.peak_priority(); });
+    assert(errors_caught == 4);
+}
+
+
+int main() {
+    std::cout << "Testing shortest paths against MinHeap...\n";
+    test_dijkstra();
+
+    std::cout << "Testing duplicate values...\n";
+    test_duplicates();
+
+    std::cout << "Testing that stale entries are skipped...\n";
+    test_staleness();
+
+    std::cout << "Testing move only values...\n";
+    test_move_only();
+
+    std::cout << "Testing that misuse throws useful exceptions...\n";
+    test_exceptions();
+}
@@ -0,0 +1,521 @@
+
+#include "min_heap.h"
+#include "range.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+struct Order {
+public:
+    std::string product;
+    int cost;
+
+    Order(std::string product, int cost)
+        : product {product}, cost {cost} 
+    {} 
+
+    bool operator==(const Order& other) const {
+        return cost == other.cost && product == other.product;
+    } 
+};
+
+template<>
+struct std::hash<Order> {
+    std::size_t operator()(const Order& order) const {
+        return std::hash<string>()(order.product) ^ (hash<int>()(order.cost));    
+    }
+};
+
+// Negative priorities ensure minimum is largest or most important order.
+const std::array<Order, 8> orders {
+    Order("pants", 15),
+    Order("iphone", 900),
+    Order("hotdogs", 7),
+    Order("elephant", 15000),
+    Order("lint", 1),
+    Order("Mona Lisa", 1000000000),
+    Order("cheese sticks", 13),
+    Order("baguette", 10),
+};
+
+// Negative priorities ensure minimum is largest or most important order.
+const std::array<std::pair<Order, int>, 8> orders_and_priority {
+    std::pair{Order("pants", 15), -15},
+    std::pair{Order("iphone", 900), -900},
+    std::pair{Order("hotdogs", 7), -7},
+    std::pair{Order("elephant", 15000), -15000},
+    std::pair{Order("lint", 1), -1},
+    std::pair{Order("Mona Lisa", 1000000000), -1000000000},
+    std::pair{Order("cheese sticks", 13), -13},
+    std::pair{Order("baguette", 10), -10}
+};
+
+
+void test_heapify() {
+    Util::MinHeap<Order> q (orders, [](const Order& o) {
+        return -o.cost; // Negative cost ensures that high costs come out first.
+    });
+
+    std::vector<std::string> expected {
+        "Mona Lisa", "elephant", "iphone", "pants", "cheese sticks", "baguette", "hotdogs", "lint"
+    };
+    std::vector<std::string> found {};
+
+    assert(q.size() == 8);
+
+    while (!q.is_empty()) {
+        Order o = q.pop_min();
+        found.push_back(o.product);
+    }
+
+    assert(expected == found);
+    assert(q.size() == 0);
+}
+
+void test_insert() {
+    Util::MinHeap<Order> q {};
+
+    for (const auto& [order, priority] : orders_and_priority) {
+        q.insert(order, priority);
+    }
+
+    std::vector<std::string> expected {
+        "Mona Lisa", "elephant", "iphone", "pants", "cheese sticks", "baguette", "hotdogs", "lint"
+    };
+    std::vector<std::string> found {};
+
+    while (!q.is_empty()) {
+        Order o = q.pop_min();
+        found.push_back(o.product);
+    }
+
+    assert(expected == found);
+}
+
+void test_replace_value() {
+    /* heapify some */
+    Util::MinHeap<Order> q {orders_and_priority.begin(), &orders_and_priority[4]};
+
+    /* insert others */
+    for (int i {4}; i < static_cast<int>(orders_and_priority.size()); i++) {
+        q.insert(orders_and_priority[i].first, orders_and_priority[i].second);
+    }
+
+    /* Update some the the keys */
+    q.update_priority(Order("iphone", 900), -3);
+    q.update_priority(Order("baguette", 10), -70);
+
+    std::vector<std::string> expected {
+        "Mona Lisa", "elephant", "baguette", "pants", "cheese sticks", "hotdogs", "iphone", "lint"
+    };
+    std::vector<std::string> found {};
+
+    while (!q.is_empty()) {
+        Order o = q.pop_min();
+        found.push_back(o.product);
+    }
+    
+    assert(expected == found);
+}
+
+void test_peak_min() {
+    Util::MinHeap<Order> q (orders, [](const Order& o) {
+        return -o.cost; // Negative cost ensures that high costs come out first.
+    });
+
+    assert(q.peak_min().product == "Mona Lisa");
+    assert(q.peak_min().product == "Mona Lisa");
+    assert(q.peak_min().product == "Mona Lisa");
+
+    q.insert(Order("2 Mona Lisas", 2 * q.peak_min().cost), - 2 * q.peak_min().cost);
+
+    assert(q.peak_min().product == "2 Mona Lisas");
+    assert(q.peak_min().product == "2 Mona Lisas");
+    assert(q.peak_min().product == "2 Mona Lisas");
+}
+
+void test_exceptions() {
+    Util::MinHeap<int> q {};
+
+    int errors_caught {0};
+    
+    try {
+        q.peak_min();    
+    } catch (Util::MinHeapException e) {
+        errors_caught++;
+    }
+
+    try {
+        q.pop_min();    
+    } catch (Util::MinHeapException e) {
+        errors_caught++;
+    }
+
+    try {
+        q.update_priority(1, 5);    
+    } catch (Util::MinHeapException e) {
+        errors_caught++;
+    }
+
+    q.insert(2, 2);
+
+    try {
+        q.insert(2, 3);    
+    } catch (Util::MinHeapException e) {
+        errors_caught++;
+    }
+
+    assert(errors_caught == 4);
+}
+
+void test_large_shuffle() {
+    std::random_device rd;
+    std::mt19937 g(rd());
+
+    int N = 100000;
+
+    Util::Range r(N);
+    std::vector<int> vec (r.begin(), r.end());
+    std::shuffle(vec.begin(), vec.end(), g);
+
+    Util::MinHeap<int> q (vec, [](int i){
+        return i;
+    });
+
+    Util::MinHeap<int> q2 {};
+
+    for (int i {0}; i < N; i++) {
+        assert(q.pop_min() == i);
+        q2.insert(i, i);
+        assert(q2.size() == i + 1);
+    }
+
+    for (int i {0}; i < N; i+=2) {
+        q2.update_priority(i, -i);
+    }
+
+    for (int i {1}; i < N; i+=2) {
+        q2.update_priority(i, 3*i); // Increasing priority should also be tested.
+    }
+
+    for (int i {0}; i < N; i+=7) {
+        q2.remove(i);
+    }
+
+    for (int i {N - 2}; i >= 0; i-=2) {
+        if (i % 7 == 0)
+            continue;
+        assert(i == q2.pop_min());
+        if ((i + 1) % 7 != 0) {
+            assert(q2.contains(i + 1)); // We'll also test contains
+            assert(q2.get_priority(i+1) == 3 * (i+1)); // And get_priority
+        }
+    }
+
+    for (int i {1}; i < N; i+=2) {
+        if (i % 7 == 0)
+            continue;
+        assert(i == q2.pop_min());
+    }
+}
+
+void test_remove() {
+    Util::MinHeap<Order> q (orders, [](const Order& o) {
+        return -o.cost; // Negative cost ensures that high costs come out first.
+    });
+
+    std::vector<std::string> expected {
+        "Mona Lisa", "elephant", "iphone", "cheese sticks", "baguette", "hotdogs", "lint"
+    };
+    std::vector<std::string> found {};
+
+    q.remove(Order("pants", 15));
+
+    while (!q.is_empty()) {
+        Order o = q.pop_min();
+        found.push_back(o.product);
+        assert(o.product != "pants");
+    }
+
+    assert(expected == found);
+}
+
+/* Both paths of each batch operation, small batches sifting and large ones
+ * rebuilding, checked against a plain map of priorities. */
+void test_batches() {
+    std::mt19937 g(7);
+    Util::MinHeap<int, int, 4> heap {};
+    std::unordered_map<int, int> expected {};
+
+    auto check = [&]() {
+        Util::MinHeap<int, int, 4> copy {heap};
+        assert(copy.size() == static_cast<int>(expected.size()));
+        int previous {INT32_MIN};
+        while (!copy.is_empty()) {
+            int p {copy.get_priority(copy.peak_min())};
+            assert(expected.at(copy.pop_min()) == p && p >= previous);
+            previous = p;
+        }
+    };
+
+    int next_value {0};
+    for (int count : {1000, 50, 3000, 10}) {
+        std::vector<std::pair<int, int>> batch {};
+        for (int i {0}; i < count; i++) {
+            batch.push_back({next_value, static_cast<int>(g() % 100000)});
+            expected[next_value] = batch.back().second;
+            next_value++;
+        }
+        heap.insert_batch(batch);
+        check();
+    }
+
+    // 30% of the heap, then a handful, as a tick of the simulation would.
+    for (int count : {next_value * 3 / 10, 5}) {
+        std::vector<std::pair<int, int>> batch {};
+        for (int i {0}; i < count; i++) {
+            int v = g() % next_value;
+            batch.push_back({v, static_cast<int>(g() % 100000)});
+            expected[v] = batch.back().second;
+        }
+        heap.update_batch(batch);
+        check();
+    }
+
+    // On error, the earlier entries of the batch stay applied, and the heap is
+    // still a heap.
+    for (int count : {3, 5000}) {
+        // Each round's priorities are below everything before.
+        const int low {-count};
+        std::vector<std::pair<int, int>> batch {{next_value, low}, {0, 5}};
+        for (int i {0}; i < count; i++) {
+            batch.push_back({next_value + 1 + i, 0});
+        }
+        expected[next_value] = low;
+        try {
+            heap.insert_batch(batch);
+            assert(false);
+        }
+        catch (Util::MinHeapException&) {}
+        assert(heap.peak_min() == next_value && !heap.contains(next_value + 1));
+        next_value++;
+        check();
+
+        batch = {{0, low - 1}, {-1, 5}};
+        for (int i {0}; i < count; i++) {
+            batch.push_back({i + 1, 0});
+        }
+        expected[0] = low - 1;
+        try {
+            heap.update_batch(batch);
+            assert(false);
+        }
+        catch (Util::MinHeapException&) {}
+        assert(heap.peak_min() == 0 && heap.get_priority(1) != 0);
+        check();
+    }
+}
+
+/* Counts copies, to check that the heap never makes any. */
+struct Tracked {
+    static inline int copies {0};
+
+    int id;
+
+    Tracked(int id) : id {id} {}
+    Tracked(const Tracked& other) : id {other.id} {
+        copies++;
+    }
+    Tracked(Tracked&& other) = default;
+
+    bool operator==(const Tracked& other) const {
+        return id == other.id;
+    }
+};
+
+template<>
+struct std::hash<Tracked> {
+    std::size_t operator()(const Tracked& tracked) const {
+        return std::hash<int>()(tracked.id);
+    }
+};
+
+void test_move_only() {
+    Util::MinHeap<std::unique_ptr<int>, int, 4> q {};
+    for (int i {0}; i < 100; i++) {
+        q.insert(std::make_unique<int>(i), (i * 37) % 100);
+    }
+    q.emplace(-1, new int(1000));
+    assert(*q.peak_min() == 1000);
+
+    std::unique_ptr<int> first {q.pop_min()};
+    assert(*first == 1000);
+    for (int i {0}; i < 100; i++) {
+        std::unique_ptr<int> next {q.pop_min()};
+        assert((*next * 37) % 100 == i);
+    }
+
+    Util::MinHeap<Tracked> tracked {};
+    for (int i {0}; i < 1000; i++) {
+        tracked.emplace((i * 7919) % 1000, i);
+    }
+    for (int i {0}; i < 1000; i += 2) {
+        tracked.update_priority(Tracked(i), -i);
+    }
+    tracked.remove(Tracked(1));
+    assert(tracked.contains(Tracked(3)) && !tracked.contains(Tracked(1)));
+    assert(tracked.get_priority(Tracked(998)) == -998);
+    assert(tracked.pop_min().id == 998);
+    assert(tracked.size() == 998);
+    assert(Tracked::copies == 0);
+
+    // Batches move out of rvalue and prvalue elements, and convert other pairs.
+    auto make_pointers = [](int first, int last) {
+        return std::views::iota(first, last) | std::views::transform([](int i) {
+            return std::pair {std::make_unique<int>(i), -i};
+        });
+    };
+    Util::MinHeap<std::unique_ptr<int>, int, 4> pointers {};
+    pointers.insert_batch(make_pointers(0, 500));
+    pointers.insert_batch(make_pointers(500, 510));
+    assert(pointers.size() == 510 && *pointers.pop_min() == 509);
+
+    std::vector<std::pair<Tracked, int>> moved {};
+    for (int i {2000}; i < 2010; i++) {
+        moved.emplace_back(Tracked(i), -i);
+    }
+    tracked.insert_batch(moved | std::views::transform([](std::pair<Tracked, int>& item) -> std::pair<Tracked, int>&& {
+        return std::move(item);
+    }));
+    std::vector<std::pair<int, short>> converted {{2010, -3000}, {2000, 5}};
+    tracked.insert_batch(converted | std::views::take(1));
+    tracked.update_batch(converted | std::views::drop(1));
+    assert(tracked.pop_min().id == 2010 && tracked.pop_min().id == 2009);
+    assert(tracked.get_priority(Tracked(2000)) == 5);
+    tracked.remove(Tracked(2000));
+    for (int i {2001}; i < 2009; i++) {
+        tracked.remove(Tracked(i));
+    }
+    assert(Tracked::copies == 0);
+
+    // Copies are deep, and independent of the original.
+    Util::MinHeap<Tracked> copy {tracked};
+    assert(Tracked::copies == 998);
+    copy.update_priority(Tracked(3), -5000);
+    assert(copy.peak_min().id == 3 && tracked.peak_min().id == 996);
+    copy = tracked;
+    assert(copy.pop_min().id == 996 && tracked.peak_min().id == 996);
+}
+
+template<int Arity>
+void check_arity() {
+    std::mt19937 g(Arity);
+
+    int N = 20000;
+    Util::Range r(N);
+    std::vector<int> vec (r.begin(), r.end());
+    std::shuffle(vec.begin(), vec.end(), g);
+
+    Util::MinHeap<int, long, Arity> q (vec, [](int i){
+        return i;
+    });
+    Util::MinHeap<int, long, Arity> q2 {};
+    for (int i : vec) {
+        q2.insert(i, -i);
+    }
+
+    for (int i {0}; i < N; i += 3) {
+        q.update_priority(i, i - N);
+        q2.remove(i);
+    }
+
+    for (int i {0}; i < N; i++) {
+        if (i % 3 == 0) {
+            assert(q.pop_min() == i);
+        }
+    }
+    for (int i {0}; i < N; i++) {
+        if (i % 3 != 0) {
+            assert(q.pop_min() == i);
+        }
+    }
+    for (int i {N - 1}; i >= 0; i--) {
+        if (i % 3 != 0) {
+            assert(q2.pop_min() == i);
+        }
+    }
+    assert(q.is_empty() && q2.is_empty());
+}
+
+void test_arity() {
+    check_arity<2>();
+    check_arity<3>();
+    check_arity<4>();
+    check_arity<8>();
+
+    // Priorities are stored apart from values, so with 8 byte priorities and 8
+    // children each, every sibling group is one line.
+    Util::__Util__Impl::ChildAlignedAllocator<long> allocator;
+    long* priorities {allocator.allocate(1000)};
+    for (int parent {0}; parent * 8 + 1 < 1000; parent++) {
+        assert(reinterpret_cast<std::uintptr_t>(&priorities[parent * 8 + 1]) % 64 == 0);
+    }
+    allocator.deallocate(priorities, 1000);
+}
+
+void test_with_range() {
+    Util::MinHeap<int> q (Util::Range(100), [](int i) {
+        return i;
+    });
+
+    for (int i : Util::Range(100)) {
+        assert(i == q.pop_min());
+    }
+}
+
+
+int main() {
+    std::cout << "Testing that creating a new heap sorts the items...\n";
+    test_heapify(); 
+
+    std::cout << "Testing that inserting into an existing heap works...\n";
+    test_insert(); 
+
+    std::cout << "Testing that update key works...\n";
+    test_replace_value();
+
+    std::cout << "Testing that peak_min works...\n";
+    test_peak_min();
+
+    std::cout << "Testing that pop_min, peak_min, update_priority, and insert throw useful exception...\n";
+    test_exceptions();
+
+    std::cout << "Testing that the heap works with large inputs...\n";
+    test_large_shuffle();
+
+    std::cout << "Testing removal of element...\n";
+    test_remove();
+
+    std::cout << "Testing batch inserts and updates...\n";
+    test_batches();
+
+    std::cout << "Testing with Range...\n";
+    test_with_range();
+
+    std::cout << "Testing heaps of other arities...\n";
+    test_arity();
+
+    std::cout << "Testing move only values and emplace...\n";
+    test_move_only();
+}
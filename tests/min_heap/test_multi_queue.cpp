@@ -0,0 +1,212 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+/* With one shard there is nothing to relax: pops come out in order. */
+void test_single_shard() {
+    Util::MultiQueue<int> queue (1, 1);
+    assert(queue.get_shard_count() == 1);
+
+    std::mt19937 g(3);
+    std::vector<int> priorities {};
+    for (int i {0}; i < 1000; i++) {
+        priorities.push_back(g() % 10000);
+        queue.insert(i, priorities.back());
+    }
+    assert(queue.approximate_size() == 1000);
+
+    std::sort(priorities.begin(), priorities.end());
+    for (int p : priorities) {
+        auto popped {queue.try_pop_min()};
+        assert(popped && popped->second == p);
+    }
+    assert(!queue.try_pop_min());
+
+    Util::MultiQueueStats stats {queue.get_stats()};
+    assert(stats.inserts == 1000 && stats.pops == 1000 && stats.inversions == 0);
+    queue.reset_stats();
+    assert(queue.get_stats().pops == 0);
+}
+
+/* With many shards, everything still comes out exactly once, roughly in order. */
+void test_relaxed_order() {
+    const int count {20000};
+    Util::MultiQueue<int> queue (4, 2);
+    for (int i {0}; i < count; i++) {
+        queue.insert(i, i);
+    }
+
+    std::vector<bool> seen (count, false);
+    long total_displacement {0};
+    for (int rank {0}; rank < count; rank++) {
+        auto popped {queue.try_pop_min()};
+        assert(popped && !seen[popped->first]);
+        seen[popped->first] = true;
+        total_displacement += std::abs(popped->first - rank);
+    }
+    assert(!queue.try_pop_min() && queue.approximate_size() == 0);
+
+    // Far closer to sorted than to random, which would be about count / 3.
+    assert(total_displacement / count < 100);
+    Util::MultiQueueStats stats {queue.get_stats()};
+    assert(stats.pops == count && stats.inversions <= stats.pops);
+}
+
+/* Stale entries are dropped inside the shards, and never come out. */
+void test_staleness() {
+    std::vector<bool> cancelled (1000, false);
+    Util::MultiQueue<int> queue (2, 2, [&cancelled](const int& v, const int&) {
+        return cancelled[v];
+    });
+    for (int i {0}; i < 1000; i++) {
+        queue.insert(i, i);
+        cancelled[i] = i % 2 == 0;
+    }
+
+    int count {0};
+    while (auto item {queue.try_pop_min()}) {
+        assert(item->first % 2 == 1);
+        count++;
+    }
+    assert(count == 500 && queue.get_stats().pops == 500);
+}
+
+/* Threads inserting and popping at once lose and duplicate nothing. */
+void test_concurrent() {
+    const int threads {4};
+    const int per_thread {20000};
+    Util::MultiQueue<int> queue (threads);
+
+    std::vector<std::atomic<int>> popped (threads * per_thread);
+    std::vector<std::thread> workers {};
+    for (int t {0}; t < threads; t++) {
+        workers.emplace_back([&queue, &popped, t]() {
+            std::mt19937 g(t);
+            for (int i {0}; i < per_thread; i++) {
+                queue.insert(t * per_thread + i, g() % 1000);
+                if (i % 2 == 1) {
+                    auto item {queue.try_pop_min()};
+                    assert(item);
+                    popped[item->first]++;
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    while (auto item {queue.try_pop_min()}) {
+        popped[item->first]++;
+    }
+    for (std::atomic<int>& count : popped) {
+        assert(count == 1);
+    }
+    Util::MultiQueueStats stats {queue.get_stats()};
+    assert(stats.inserts == threads * per_thread && stats.pops == threads * per_thread);
+}
+
+/* Parallel shortest paths in a grid. Vertices are inserted again whenever their
+ * distance improves, so the queue holds duplicates. */
+void test_parallel_dijkstra() {
+    const int width {120};
+    std::vector<int> weights {random_weights(width, 100)};
+    std::vector<long> expected {expected_distances(width, weights)};
+
+    const int threads {4};
+    std::vector<std::atomic<long>> distance (width * width);
+    for (std::atomic<long>& d : distance) {
+        d = INT64_MAX;
+    }
+    Util::MultiQueue<int, long> queue (threads);
+
+    // Entries inserted but not yet popped and processed; the search is over at 0.
+    std::atomic<int> pending {1};
+    distance[0] = 0;
+    queue.insert(0, 0);
+
+    std::vector<std::thread> workers {};
+    for (int t {0}; t < threads; t++) {
+        workers.emplace_back([&]() {
+            while (pending.load() > 0) {
+                auto item {queue.try_pop_min()};
+                if (!item) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                auto [v, d] {*item};
+                if (d > distance[v].load()) {
+                    // A shorter path was found since; this entry is out of date.
+                    pending--;
+                    continue;
+                }
+
+                int neighbours[] {v - width, v + width, v % width == 0 ? -1 : v - 1, v % width == width - 1 ? -1 : v + 1};
+                for (int u : neighbours) {
+                    if (u < 0 || u >= width * width) {
+                        continue;
+                    }
+                    long through_v {d + weights[u]};
+                    long current {distance[u].load()};
+                    while (through_v < current && !distance[u].compare_exchange_weak(current, through_v)) {}
+                    if (through_v < current) {
+                        pending++;
+                        queue.insert(u, through_v);
+                    }
+                }
+                pending--;
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (int v {0}; v < width * width; v++) {
+        assert(distance[v] == expected[v]);
+    }
+}
+
+void test_exceptions() {
+    int errors_caught {0};
+    try {
+        Util::MultiQueue<int> queue (2, 0);
+    }
+    catch (Util::MinHeapException&) {
+        errors_caught++;
+    }
+    assert(errors_caught == 1);
+
+    Util::MultiQueue<int> queue {};
+    assert(queue.get_shard_count() >= 2 && !queue.try_pop_min());
+}
+
+
+int main() {
+    std::cout << "Testing that one shard is an ordinary priority queue...\n";
+    test_single_shard();
+
+    std::cout << "Testing that many shards are roughly in order...\n";
+    test_relaxed_order();
+
+    std::cout << "Testing that stale entries are skipped...\n";
+    test_staleness();
+
+    std::cout << "Testing concurrent inserts and pops...\n";
+    test_concurrent();
+
+    std::cout << "Testing parallel shortest paths against MinHeap...\n";
+    test_parallel_dijkstra();
+
+    std::cout << "Testing that misuse throws useful exceptions...\n";
+    test_exceptions();
+}
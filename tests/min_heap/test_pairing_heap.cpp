@@ -0,0 +1,199 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/* Shortest distances from vertex 0 in a width by width grid of random edge
+ * weights, keeping a handle per vertex instead of looking vertices up. */
+std::vector<long> dijkstra(int width, const std::vector<int>& weights) {
+    using Heap = Util::PairingHeap<int, long>;
+    Heap heap {};
+    std::vector<Heap::Handle> handles (width * width);
+    std::vector<bool> queued (width * width, false);
+    std::vector<long> distance (width * width, -1);
+
+    handles[0] = heap.insert(0, 0);
+    queued[0] = true;
+    while (!heap.is_empty()) {
+        long d {heap.get_priority(handles[heap.peak_min()])};
+        int v {heap.pop_min()};
+        distance[v] = d;
+
+        int neighbours[] {v - width, v + width, v % width == 0 ? -1 : v - 1, v % width == width - 1 ? -1 : v + 1};
+        for (int u : neighbours) {
+            if (u < 0 || u >= width * width || distance[u] != -1) {
+                continue;
+            }
+            long through_v {d + weights[u]};
+            if (!queued[u]) {
+                handles[u] = heap.insert(u, through_v);
+                queued[u] = true;
+            }
+            else if (through_v < heap.get_priority(handles[u])) {
+                heap.update_priority(handles[u], through_v);
+            }
+        }
+    }
+    return distance;
+}
+
+void test_dijkstra() {
+    const int width {150};
+    std::vector<int> weights {random_weights(width, 100)};
+    std::vector<long> expected {expected_distances(width, weights)};
+
+    assert(dijkstra(width, weights) == expected);
+}
+
+/* Random inserts, pops, raises, lowers and removes, checked against MinHeap. */
+void test_against_min_heap() {
+    using Heap = Util::PairingHeap<std::string, int>;
+    std::mt19937 g(11);
+    Util::MinHeap<std::string, int> expected {};
+    Heap heap {};
+    std::vector<Heap::Handle> handles {};
+    std::vector<bool> live {};
+
+    for (int step {0}; step < 20000; step++) {
+        int choice = g() % 10;
+        if (choice < 4 || heap.is_empty()) {
+            std::string name {std::to_string(handles.size()) + "#"};
+            int p = g() % 10000;
+            expected.insert(name, p);
+            handles.push_back(heap.insert(name, p));
+            live.push_back(true);
+        }
+        else if (choice < 6) {
+            assert(heap.get_priority(handles[std::stoi(heap.peak_min())]) == expected.get_priority(expected.peak_min()));
+            std::string popped {heap.pop_min()};
+            int p {expected.get_priority(popped)};
+            assert(p == expected.get_priority(expected.peak_min()));
+            expected.remove(popped);
+            live[std::stoi(popped)] = false;
+        }
+        else {
+            int i = g() % handles.size();
+            if (!live[i]) {
+                continue;
+            }
+            std::string name {heap.get_value(handles[i])};
+            assert(name == std::to_string(i) + "#");
+            if (choice == 9) {
+                heap.remove(handles[i]);
+                expected.remove(name);
+                live[i] = false;
+            }
+            else {
+                // Mostly lowered, sometimes raised.
+                int p = choice == 8 ? heap.get_priority(handles[i]) + g() % 1000 : g() % 10000;
+                heap.update_priority(handles[i], p);
+                expected.update_priority(name, p);
+            }
+        }
+        assert(heap.size() == expected.size());
+    }
+
+    while (!heap.is_empty()) {
+        assert(heap.get_priority(handles[std::stoi(heap.peak_min())]) == expected.get_priority(expected.peak_min()));
+        expected.remove(heap.pop_min());
+    }
+    assert(expected.is_empty());
+}
+
+void test_meld() {
+    using Heap = Util::PairingHeap<std::string>;
+    Heap evens {};
+    Heap odds {};
+    std::vector<Heap::Handle> handles {};
+    for (int i {0}; i < 1000; i++) {
+        handles.push_back((i % 2 == 0 ? evens : odds).insert(std::to_string(i), i));
+    }
+
+    odds.pop_min(); // Leaves some free slots in odds' pool, for evens to reuse.
+    evens.meld(odds);
+    assert(odds.is_empty() && evens.size() == 999);
+
+    // Handles from odds now work in evens.
+    evens.update_priority(handles[501], -1);
+    assert(evens.get_value(handles[501]) == "501");
+    evens.remove(handles[3]);
+    assert(evens.pop_min() == "501");
+    for (int i {0}; i < 500; i++) {
+        evens.insert("new " + std::to_string(i), 10000 + i);
+    }
+
+    int previous {-1};
+    while (!evens.is_empty()) {
+        std::string value {evens.pop_min()};
+        int i {value.starts_with("new ") ? 10000 + std::stoi(value.substr(4)) : std::stoi(value)};
+        assert(i > previous && i != 1 && i != 3 && i != 501);
+        previous = i;
+    }
+
+    // Both are reusable afterwards, and moving keeps handles valid.
+    Heap::Handle h {odds.insert("x", 5)};
+    Heap moved {std::move(odds)};
+    assert(moved.get_value(h) == "x" && odds.is_empty());
+    evens = std::move(moved);
+    assert(evens.pop_min() == "x");
+}
+
+void test_move_only() {
+    Util::PairingHeap<std::unique_ptr<int>> heap {};
+    for (int i {0}; i < 100; i++) {
+        heap.insert(std::make_unique<int>(i), (i * 37) % 100);
+    }
+    assert(*heap.peak_min() == 0);
+    for (int i {0}; i < 50; i++) {
+        heap.pop_min();
+    }
+    // The rest are destroyed along with the heap.
+    heap.clear();
+    assert(heap.is_empty());
+}
+
+void test_exceptions() {
+    Util::PairingHeap<int> heap {};
+
+    int errors_caught {0};
+    auto expect_error = [&errors_caught](auto action) {
+        try {
+            action();
+        }
+        catch (Util::MinHeapException&) {
+            errors_caught++;
+        }
+    };
+
+    expect_error([&heap]() { heap.pop_min(); });
+    expect_error([&heap]() { heap.peak_min(); });
+    expect_error([&heap]() { heap.update_priority({}, 0); });
+    expect_error([&heap]() { heap.remove({}); });
+    expect_error([&heap]() { heap.get_priority({}); });
+    assert(errors_caught == 5);
+}
+
+
+int main() {
+    std::cout << "Testing shortest paths against MinHeap...\n";
+    test_dijkstra();
+
+    std::cout << "Testing a random workload against MinHeap...\n";
+    test_against_min_heap();
+
+    std::cout << "Testing meld...\n";
+    test_meld();
+
+    std::cout << "Testing move only values...\n";
+    test_move_only();
+
+    std::cout << "Testing that misuse throws useful exceptions...\n";
+    test_exceptions();
+}
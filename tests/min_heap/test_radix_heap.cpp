@@ -0,0 +1,109 @@
+
+#include "min_heap.h"
+#include "heap_checks.h"
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+void test_dijkstra() {
+    const int width {150};
+    std::vector<int> weights {random_weights(width, 1000)};
+
+    Util::RadixHeap<int, long> radix {};
+    Util::RadixHeap<int, unsigned> radix_unsigned {};
+    std::vector<long> expected {expected_distances(width, weights)};
+    assert(dijkstra(width, weights, radix) == expected);
+    assert(dijkstra(width, weights, radix_unsigned) == expected);
+
+    // Reusable after emptying.
+    assert(dijkstra(width, weights, radix) == expected);
+}
+
+void test_against_min_heap() {
+    Util::RadixHeap<std::string, int> radix {};
+    check_against_min_heap(radix, -1000, 5000, 11); // Negative priorities work too.
+
+    // Copies are independent.
+    for (int i {0}; i < 100; i++) {
+        radix.insert(std::to_string(i), i * 37 % 101 - 50);
+    }
+    Util::RadixHeap<std::string, int> copy {radix};
+    while (!radix.is_empty()) {
+        radix.pop_min();
+    }
+    assert(copy.size() == 100 && copy.get_priority("3") == -40);
+    assert(copy.pop_min() == "0");
+}
+
+/* peak_min names the value pop_min takes, even among equal priorities. */
+void test_ties() {
+    Util::RadixHeap<int> heap {};
+    for (int v {0}; v < 200; v++) {
+        heap.insert(v, v % 7 * 100 + v % 3);
+    }
+    heap.update_priority(150, 0);
+
+    int popped {0};
+    while (!heap.is_empty()) {
+        int peaked {heap.peak_min()};
+        assert(heap.pop_min() == peaked);
+        popped++;
+        if (popped % 40 == 0) {
+            heap.insert(1000 + popped, heap.is_empty() ? 0 : heap.get_priority(heap.peak_min()));
+        }
+    }
+    assert(popped == 205);
+}
+
+void test_exceptions() {
+    Util::RadixHeap<int> heap {};
+
+    int errors_caught {0};
+    auto expect_error = [&errors_caught](auto action) {
+        try {
+            action();
+        }
+        catch (Util::MinHeapException&) {
+            errors_caught++;
+        }
+    };
+
+    expect_error([&heap]() { heap.pop_min(); });
+    expect_error([&heap]() { heap.peak_min(); });
+    expect_error([&heap]() { heap.update_priority(2, 0); });
+    expect_error([&heap]() { heap.remove(2); });
+    heap.insert(1, 10);
+    heap.insert(2, 20);
+    expect_error([&heap]() { heap.insert(2, 30); });
+    heap.insert(3, 25);
+    assert(heap.pop_min() == 1);
+    expect_error([&heap]() { heap.insert(4, 9); });
+    expect_error([&heap]() { heap.update_priority(2, 9); });
+    assert(errors_caught == 7);
+    assert(heap.get_priority(2) == 20 && !heap.contains(4));
+    heap.remove(3);
+
+    // With one value, or none, the heap can start over lower down.
+    heap.update_priority(2, 5);
+    assert(heap.pop_min() == 2);
+    heap.insert(4, -5);
+    assert(heap.pop_min() == 4);
+}
+
+
+int main() {
+    std::cout << "Testing shortest paths against MinHeap...\n";
+    test_dijkstra();
+
+    std::cout << "Testing a random workload against MinHeap...\n";
+    test_against_min_heap();
+
+    std::cout << "Testing that peak_min and pop_min agree on ties...\n";
+    test_ties();
+
+    std::cout << "Testing that misuse throws useful exceptions...\n";
+    test_exceptions();
+}